@@ -50,6 +50,7 @@
 Nextion_Object_t txtObj1, txtObj2, intObj1, slider1Obj, gauge1Obj, prgressBarObj, btn1Obj, pgButton,
 					waveForm;
 uint8_t currentPage = 0xFF;
+Nextion_DisplayList_t overlayList; //static drawing of page 1
 /* USER CODE END Variables */
 /* Definitions for Display1 */
 osThreadId_t Display1Handle;
@@ -147,6 +148,8 @@ void StartDisplay1Task(void *argument)
   /* USER CODE BEGIN StartDisplay1Task */
 	uint8_t progressBarVal = 0;
 
+	//Leave the 9600 baud of the reset, up to the highest stable rate
+	NxHmi_ComSpeedMax(NEX_BAUD_MAX, SET_TEMPORARY);
 	NxHmi_GetCurrentPageId(&currentPage);
 
 	//NxHmi_SetAutoSleep(0, 10, 0, 1);
@@ -212,6 +215,19 @@ void StartDisplay2Task(void *argument)
   /* Infinite loop */
 	uint8_t hossz = 0;
 
+	//Record the overlay once, it's replayed in one burst
+	NxHmi_DlClear(&overlayList);
+	NxHmi_DlFill(&overlayList, 10, 240, 200, 250, NEX_BLUE);
+	NxHmi_DlRect(&overlayList, 20, 290, 100, 300, NEX_GREEN);
+	NxHmi_DlCircle(&overlayList, 100, 270, 60, NEX_RED, 1);
+	NxHmi_DlCircle(&overlayList, 150, 290, 30, NEX_GREEN, 0);
+	NxHmi_DlCompile(&overlayList);
+
+	//Clear the overlay by repainting its areas instead of ref 0, page 1 has a white background
+	NxHmi_DirtySetBackground(NEX_WHITE);
+	//Area of the waveform on page 1 (x, y, w, h from the Nextion editor), refreshed where the overlay covers it
+	NxHmi_SetFootprint(&waveForm, 0, 0, 240, 250);
+
 	for (;;) {
 		switch (currentPage) {
 
@@ -229,12 +245,10 @@ void StartDisplay2Task(void *argument)
 			//NxHmi_DrawImage(0, 0, 350);
 			//NxHmi_DrawCropImage(1, 20, 276, hossz++, 40, 0, 0);
 			//NxHmi_DrawLine(10, 240, hossz++, 220 + rand() % 20, NEX_BLUE);
-			NxHmi_DrawRect(10, 240, 200, 250, NEX_BLUE, 1);
-			NxHmi_DrawRect(20, 290, 100, 300, NEX_GREEN, 0);
-			NxHmi_DrawCircle(100, 270, 60, NEX_RED, 1);
-			NxHmi_DrawCircle(150, 290, 30, NEX_GREEN, 0);
-			if (hossz == 220) {
+			NxHmi_DlReplay(&overlayList);
+			if (++hossz == 220) {
 				hossz = 0;
+				//Repaints the dirty regions of the overlay and refreshes s0
 				NxHmi_ForceRedrawComponent(NULL);
 			}
 			break;
@@ -44,24 +44,73 @@ extern "C" {
 
 //DEFINES
 
-#define NEX_RX_BUFF_SIZE 			(20) // UART RX buffer size
+#define NEX_RX_BUFF_SIZE 			(128) // UART RX ring, filled by circular DMA, power of 2, holds size/2 unparsed bytes
+#define NEX_RX_FRAME_SIZE 			(24) // Longest received frame with its terminator, a longer one is dropped
+#define NEX_TX_BUFF_COUNT 			(6)  // Number of TX staging buffers, min. 2 for double buffering
+#define NEX_TX_BUFF_SIZE 			(40) // Size of one TX staging buffer (command + 3 terminator bytes)
+#define NEX_TX_CHAIN_MAX 			(4)  // Max. number of staging buffers of one long command
+#define NEX_TX_BURST_SIZE 			(256) // Max. size of the coalesced commands sent in one transmission
+#define NEX_TX_LANE_RESERVE 		(1)  // TX buffers kept for the interactive lane
+#define NEX_TX_LOW_LANE_BURST 		(128) // Max. bytes of the bulk and background lanes in one burst, shortens the wait of the interactive lane
+#define NEX_TX_LANE_AGING 			(4)  // A lane which has been skipped this many bursts is served first
+#define NEX_TX_GATHER_TIME 			(0)  // in milliseconds, wait for more commands before a burst, 0 - off
+#define NEX_DISPLAY_SERIAL_BUFF 	(1024) // Serial input buffer size of the display
+#define NEX_BKCMD_DEFAULT 			(3)  // bkcmd level set by NxHmi_ResetDevice(), below 3 the errors can't be matched to a command of a burst
+#define NEX_UART_TX_DMA 			(1)  // 1 - transmit with DMA, 0 - transmit in interrupt mode
+#define NEX_BAUD_MAX 				(921600) // Highest rate tried by NxHmi_ComSpeedMax()
+#define NEX_BAUD_SETTLE_TIME 		(50) // in milliseconds, wait after a baud rate change
+#define NEX_BAUD_PROBE_COUNT 		(3)  // Probe commands which must pass at a new baud rate
+#define NEX_MAILBOX_SLOTS 			(8)  // Number of latest-value-wins (object, property) slots
+#define NEX_WAVE_CHANNELS 			(4)  // Number of streamed (waveform, channel) pairs
+#define NEX_WAVE_RING_SIZE 			(256) // Sample buffer of one streamed channel, holds size-1 samples
+#define NEX_WAVE_BLOCK_MAX 			(128) // Max. samples of one addt block, the line is locked during its transfer
+#define NEX_ADMIT_TASKS 			(4)  // Number of producer tasks with their own wire-time budget
+#define NEX_ADMIT_PERIOD 			(100) // in milliseconds, budget period of the producer tasks
+#define NEX_PIPELINE_DEPTH 			(8)  // Max. number of commands waiting for answer, more than one burst in flight with bkcmd=3
+#define NEX_PACE_FRAC_BITS 			(4)  // Fractional bits of the learned processing times (1/16 tick)
+#define NEX_PACE_RISE_SHIFT 		(1)  // Learning speed of a longer processing time, 1/2^n of the difference
+#define NEX_PACE_FALL_SHIFT 		(3)  // Learning speed of a shorter processing time, 1/2^n of the difference
 #define NEX_MAX_OBJECTS 			(50) //maximum objects on the display
+#define NEX_FLOAT_DECIMALS 			(2)  // Decimals of NxHmi_SetFloatValue()
+#define NEX_FLOAT_MAX_DECIMALS 		(6)  // Max. decimals of the fixed-point formatter
+#define NEX_FLOAT_TEXT_SIZE 		(20) // Sign, 10 integer digits, point, 6 decimals and zero
+#define NEX_TEXT_STREAM_MAX 		(512) // Max. bytes of a long text command streamed in one piece, longer texts are sent in += chunks
+#define NEX_DL_ITEMS 				(16) // Max. primitives of a display list
+#define NEX_DL_CODE_SIZE 			(384) // Compiled commands of a display list, in bytes
+#ifndef NEX_SCREEN_WIDTH
+#define NEX_SCREEN_WIDTH 			(240) // in pixels, the display list drops the primitives out of the screen, can be set by the build
+#endif
+#ifndef NEX_SCREEN_HEIGHT
+#define NEX_SCREEN_HEIGHT 			(400) // in pixels, can be set by the build
+#endif
+#define NEX_DIRTY_RECTS 			(8)  // Max. separate dirty regions, more are merged
+#define NEX_DIRTY_FOOTPRINTS 		(16) // Max. components with a known footprint, refreshed when a region is repainted
+#define NEX_MACRO_SLOTS 			(4)  // Max. registered display-side macros
+#define NEX_MACRO_ARGS 				(3)  // Max. packed parameters of a macro, passed in sys0-sys2
+#define NEX_PACK_WORDS 				(3)  // Max. global variables of a packed update
+#define NEX_PACK_FIELDS 			(16) // Max. numeric components of a packed update
+#define NEX_STRING_BLOCKS 			(4)  // Blocks of the string arena, returned strings borrowed by the tasks
+#define NEX_STRING_BLOCK_SIZE 		(128) // Max. length of a returned string + 1, a longer one is truncated
+#define NEX_TOUCH_HISTORY 			(16) // Touch positions kept for the drag paths, power of 2, holds size-1 positions, 0 - last position only
 
 #define NEX_ANSW_TIMEOUT 			pdMS_TO_TICKS(3000) // in milliseconds
 #define NEX_QUEUE_TIMEOUT 			pdMS_TO_TICKS(1000) // in milliseconds
+#define NEX_ASYNC_QUEUE_TIMEOUT 	pdMS_TO_TICKS(0) // in milliseconds, max. wait of an async call for a free TX buffer
 
 #define NEX_HMIOBJECTTASK_STACK 	(256 * 4) // stack size
 #define NEX_HMIOBJECTTASK_PRIORITY 	osPriorityNormal
 
 #define NEX_HMIRXTASK_STACK 		(128 * 4) // stack size
 #define NEX_HMIRXTASK_PRIORITY 		osPriorityNormal
-#define BUFF_CLEAR_PATTERN 			(0xAA)
 
 #define NEX_EVENT_SUCCESS 			(0x01)
 #define NEX_EVENT_INIT_OK 			(0x88)
 #define NEX_EVENT_UPGRADE 			(0x89)
 #define NEX_EVENT_TOUCH_HEAD 		(0x65)
 #define NEX_EVENT_POSITION_HEAD 	(0x67)
+#define NEX_EVENT_SLEEP_POSITION_HEAD (0x68)
+#define NEX_EVENT_TRANSPARENT_READY (0xFE)
+#define NEX_EVENT_TRANSPARENT_DONE 	(0xFD)
 
 #define NEX_RET_CURRENT_PAGEID_HEAD (0x66)
 #define NEX_RET_STRING_HEAD 		(0x70)
@@ -76,6 +125,8 @@ extern "C" {
 #define NEX_RET_INVALID_VARIABLE 	(0x1A)
 #define NEX_RET_INVALID_OPERATION 	(0x1B)
 
+#define NEX_MACRO_ANY_PAGE 			(0xFF) // Page_ID of a macro which is on every page
+
 #define NEX_EVENT_TOUCH 			(0x01)
 #define NEX_EVENT_RELEASE 			(0x00)
 
@@ -89,10 +140,68 @@ extern "C" {
 #define NEX_YELLOW					(65504)
 #define NEX_BROWN					(48192)
 
-// 1000ms/bps * 10 bit + 2ms is extra safety, for RX timer timeout
+// 1000ms/bps * 10 bit + 2ms is extra safety, initial period of the TX timer
 #define TOUT_PERIOD_CALC(bps) 		pdMS_TO_TICKS( ( ( (1000000U/bps) * 10U) / 1000U) + 2U )
+#define RX_RING_MASK 				(NEX_RX_BUFF_SIZE - 1U)
+#define TOUCH_RING_MASK 			(NEX_TOUCH_HISTORY - 1U)
 #define MAP_NR(x, iMin, iMax, oMin, oMax) 	( (x - iMin) * (oMax - oMin) / (iMax - iMin) + oMin)
 
+#if (NEX_TX_BURST_SIZE > NEX_DISPLAY_SERIAL_BUFF) || (NEX_TX_BURST_SIZE < (NEX_TX_BUFF_SIZE * NEX_TX_CHAIN_MAX))
+#error "NEX_TX_BURST_SIZE must fit into the display's serial buffer and hold the longest command"
+#endif
+
+#if (NEX_TX_CHAIN_MAX < 1) || ((NEX_TX_CHAIN_MAX + NEX_TX_LANE_RESERVE) >= NEX_TX_BUFF_COUNT)
+#error "NEX_TX_CHAIN_MAX must leave at least one TX buffer for the other tasks besides the lane reserve"
+#endif
+
+#if (NEX_TEXT_STREAM_MAX > NEX_DISPLAY_SERIAL_BUFF)
+#error "NEX_TEXT_STREAM_MAX must fit into the display's serial buffer"
+#endif
+
+#if (NEX_MACRO_ARGS > 3) || (NEX_MACRO_ARGS >= NEX_PIPELINE_DEPTH)
+#error "NEX_MACRO_ARGS must fit into sys0-sys2"
+#endif
+
+#if (NEX_PACK_WORDS < 1) || (NEX_PACK_WORDS >= NEX_PIPELINE_DEPTH)
+#error "NEX_PACK_WORDS and the trigger of the unpack script must fit into the pipeline"
+#endif
+
+#if (NEX_SCREEN_WIDTH < 1) || (NEX_SCREEN_WIDTH > 1280) || (NEX_SCREEN_HEIGHT < 1) || (NEX_SCREEN_HEIGHT > 1280)
+#error "NEX_SCREEN_WIDTH and NEX_SCREEN_HEIGHT must be the resolution of the display, max. 1280 pixels"
+#endif
+
+#if (NEX_DIRTY_FOOTPRINTS > 32) || (NEX_DIRTY_RECTS < 1)
+#error "NEX_DIRTY_FOOTPRINTS must fit into a 32 bit mask"
+#endif
+
+#if (NEX_WAVE_BLOCK_MAX > NEX_TX_BURST_SIZE) || (NEX_WAVE_RING_SIZE < 2)
+#error "NEX_WAVE_BLOCK_MAX must fit into a burst"
+#endif
+
+#if (NEX_TOUCH_HISTORY & (NEX_TOUCH_HISTORY - 1)) || (NEX_TOUCH_HISTORY == 1)
+#error "NEX_TOUCH_HISTORY must be 0 or a power of 2, min. 2"
+#endif
+
+#if (NEX_TX_LANE_RESERVE >= NEX_TX_BUFF_COUNT) || (NEX_TX_LOW_LANE_BURST > NEX_TX_BURST_SIZE)
+#error "NEX_TX_LANE_RESERVE must leave TX buffers for the other lanes, NEX_TX_LOW_LANE_BURST must fit into a burst"
+#endif
+
+#if (NEX_STRING_BLOCKS < 1) || (NEX_STRING_BLOCKS > 32) || (NEX_STRING_BLOCK_SIZE < 2)
+#error "NEX_STRING_BLOCKS must fit into a 32 bit mask"
+#endif
+
+#if (NEX_RX_FRAME_SIZE < 9) || (NEX_RX_FRAME_SIZE > 0xFF)
+#error "NEX_RX_FRAME_SIZE must hold the longest fixed frame (0x67, 9 bytes)"
+#endif
+
+#if (NEX_BKCMD_DEFAULT < 0) || (NEX_BKCMD_DEFAULT > 3)
+#error "NEX_BKCMD_DEFAULT must be a bkcmd level, 0-3"
+#endif
+
+#if (NEX_RX_BUFF_SIZE < 32) || (NEX_RX_BUFF_SIZE > 0x8000) || (NEX_RX_BUFF_SIZE & (NEX_RX_BUFF_SIZE - 1))
+#error "NEX_RX_BUFF_SIZE must be a power of 2, hold a burst of answers and fit into the DMA counter"
+#endif
+
 typedef enum {
 	OBJ_HIDE = 0,
 	OBJ_SHOW = 1
@@ -121,13 +230,35 @@ typedef enum {
 
 
 typedef enum {
-	STAT_ERROR = -2,
+	STAT_BUSY = -3,
+	STAT_ERROR,
 	STAT_TIMEOUT,
 	STAT_FAILED,
 	STAT_OK
 } Ret_Status_t;
 
 
+typedef enum {
+	SHADOW_VAL = 0,
+	SHADOW_TXT,
+	SHADOW_BCO,
+	SHADOW_PCO,
+	SHADOW_VIS,
+	SHADOW_PROP_COUNT
+} Nx_Shadow_Prop_t;
+
+
+typedef struct Nextion_Shadow_t {
+	uint32_t value[SHADOW_PROP_COUNT]; //last value written to the display, text is stored as hash
+	uint8_t validMask;	//one bit per property
+	uint8_t pendingCnt[SHADOW_PROP_COUNT]; //queued writes without answer, the value is valid when all are answered
+	uint16_t generation;	//cache is valid only within the same page/reset generation
+	uint32_t elidedCnt;	//number of skipped writes
+
+} Nextion_Shadow_t;
+
+
+//Objects must be static or zero initialized, the library managed fields at the end must start as 0/NULL
 typedef struct Nextion_Object_t {
 	char *Name;
 	uint8_t Page_ID;
@@ -138,28 +269,371 @@ typedef struct Nextion_Object_t {
 		//If no function is assigned to event pointers, then initialize the function pointer wit NULL
 	void (*PressCallback)();	//Press event callback function pointer
 	void (*ReleaseCallback)();	//Release event callback function pointer
+		//Library managed, not part of the positional initializer
+	const char *pNameCached; //Name the length was measured of, a new Name pointer is measured again
+	uint8_t NameLength; //cached length of Name, read it with encodeNameLength()
+		//Optional cache of the last written values, attach with NxHmi_AttachShadow(), otherwise NULL
+	Nextion_Shadow_t *pShadow;
 
 } Nextion_Object_t;
 
 
+typedef enum {
+	EXPECT_NONE = 0,	//no answer is matched, it goes to waitForAnswer()
+	EXPECT_ACK,			//success (0x01) or error code, depending on bkcmd
+	EXPECT_NUMBER,		//numeric data (0x71)
+	EXPECT_RAW,			//raw 32 bit number (prints <var>,4), 4 bytes without head and terminator
+	EXPECT_STRING,		//string data (0x70)
+	EXPECT_PAGE,		//current page id (0x66)
+	EXPECT_READY,		//ready for transparent data (0xFE), the line is locked until EXPECT_DONE
+	EXPECT_DONE			//transparent data finished (0xFD)
+} Nx_Expect_t;
+
+
+typedef enum {
+	PACE_SET = 0,	//attribute assignment, n0.val=1
+	PACE_QUERY,		//get, sendme
+	PACE_DRAW,		//pic, xpic, fill, line, draw, cir, cirs, xstr
+	PACE_REFRESH,	//ref, page, cls
+	PACE_SYSTEM,	//dim, bkcmd, sleep, baud, ...
+	PACE_CLASS_COUNT
+} Nx_Pace_Class_t;
+
+
+typedef struct Nextion_Pace_t {
+	uint32_t estimate; //expected processing time, in 1/2^NEX_PACE_FRAC_BITS ticks
+	uint16_t maxTime; //longest measured processing time, in ticks
+	uint32_t samples; //number of learned answers
+
+} Nextion_Pace_t;
+
+
+typedef enum {
+	TOKEN_IDLE = 0,
+	TOKEN_PENDING,
+	TOKEN_DONE
+} Nx_Token_State_t;
+
+
+typedef struct Nextion_Token_t {
+	volatile Nx_Token_State_t state;
+	volatile Ret_Status_t status;
+	TaskHandle_t xTaskWaiting;
+		//Called from the RX or the timer task when the command is completed, keep it short, initialize with NULL if not used
+	void (*CompleteCallback)(struct Nextion_Token_t *pToken);
+	void *pUserData;
+	struct Ret_Command_t *pResult; //returned data is copied here, NULL if not required
+
+} Nextion_Token_t;
+
+
+typedef enum {
+	LANE_INTERACTIVE = 0,	//commands of the touch callbacks
+	LANE_BULK,				//commands of the other tasks
+	LANE_BACKGROUND,		//streaming, waveform samples
+	LANE_COUNT
+} Nx_Tx_Lane_t;
+
+
+typedef struct Nextion_Lane_t {
+	osMessageQueueId_t readyQHandle; //formatted commands waiting for the wire
+	uint8_t age; //bursts since the lane has been skipped while waiting
+	uint8_t maxDepth; //most commands waiting at once
+	uint32_t sentCnt; //commands put on the wire
+	uint32_t agedCnt; //bursts in which the lane has been served first because of aging
+
+} Nextion_Lane_t;
+
+
+typedef struct Nextion_WaveChannel_t {
+	Nextion_Object_t *pObject; //waveform, NULL if the slot is free
+	uint8_t channel;
+	uint8_t ring[NEX_WAVE_RING_SIZE];
+	volatile uint16_t head; //written by NxHmi_WaveStreamAdd()
+	volatile uint16_t tail; //written by NxHmi_WaveStreamFlush()
+	uint32_t dropCnt; //samples dropped, the ring was full
+
+} Nextion_WaveChannel_t;
+
+
+typedef enum {
+	ADMIT_DEFER = 0,	//blocking calls wait for the next budget period, the async ones return STAT_BUSY
+	ADMIT_COALESCE,		//numeric property writes go to the mailbox, the other commands are deferred
+	ADMIT_REJECT		//return STAT_BUSY
+} Nx_Admit_Policy_t;
+
+
+typedef enum {
+	DL_FILL = 0,	//fill x,y,w,h,color
+	DL_RECT,		//draw x1,y1,x2,y2,color
+	DL_LINE,		//line x1,y1,x2,y2,color
+	DL_CIRCLE,		//cir x,y,r,color
+	DL_CIRCLE_FILL,	//cirs x,y,r,color
+	DL_PIC,			//pic x,y,id
+	DL_XPIC,		//xpic x,y,w,h,x0,y0,id
+	DL_PRIM_COUNT
+} Nx_Dl_Prim_t;
+
+
+typedef struct Nextion_Admit_t {
+	TaskHandle_t xTask; //producer task, NULL if the slot is free
+	uint32_t budget; //wire and processing time per period, in microseconds, 0 - unlimited
+	uint32_t used; //in the current period, in microseconds
+	TickType_t xPeriodStart;
+	Nx_Admit_Policy_t policy;
+	uint32_t admittedCnt;
+	uint32_t deferCnt;
+	uint32_t coalesceCnt;
+	uint32_t rejectCnt;
+
+} Nextion_Admit_t;
+
+
+typedef enum {
+	DIRTY_BG_NONE = 0,	//not set, the page is refreshed with ref 0
+	DIRTY_BG_COLOR,		//regions are filled with a color
+	DIRTY_BG_PIC		//regions are cropped from the background picture
+} Nx_Dirty_Bg_t;
+
+
+typedef struct Nextion_Box_t {
+	int32_t x0, y0; //upper left corner
+	int32_t x1, y1; //lower right corner, inclusive, empty if x1 < x0
+} Nextion_Box_t;
+
+
+typedef struct Nextion_Footprint_t {
+	Nextion_Object_t *pObject; //NULL if the slot is free
+	Nextion_Box_t area;
+} Nextion_Footprint_t;
+
+
+typedef enum {
+	MACRO_TRIGGER_CLICK = 0,	//click <name>,1 - touch press event of a hotspot
+	MACRO_TRIGGER_TIMER			//<name>.en=1 - timer event, the script disables its timer
+} Nx_Macro_Trigger_t;
+
+
+typedef enum {
+	MACRO_OP_USER = 0,		//run with NxHmi_MacroRun() only
+	MACRO_OP_AUTOSLEEP,		//NxHmi_SetAutoSleep(), sys0 = slNoSer | slNoTouch << 16, sys1 = wkpSer | wkpTouch << 1
+	MACRO_OP_COUNT
+} Nx_Macro_Op_t;
+
+
+typedef struct Nextion_Macro_t {
+	char *Name; //hotspot or timer component which runs the script
+	uint8_t Page_ID; //page of the component, NEX_MACRO_ANY_PAGE if every page has it
+	Nx_Macro_Trigger_t trigger;
+	Nx_Macro_Op_t op; //driver operation replaced by the macro
+	uint8_t verified; //1 - the component has been found by NxHmi_MacroVerify()
+	uint32_t runCnt;
+} Nextion_Macro_t;
+
+
+typedef struct Nextion_PackField_t {
+	Nextion_Object_t *pObject; //numeric component, its val is set by the unpack script
+	uint8_t bits; //width of the field, 1-32
+	uint8_t word; //index of the global variable
+	uint8_t shift; //position of the field in the variable
+} Nextion_PackField_t;
+
+
+typedef struct Nextion_Pack_t {
+	char *Vars[NEX_PACK_WORDS]; //global variables, e.g. "sys0" or "page0.va0.val", NULL after the last one
+	Nextion_Macro_t *pMacro; //hotspot or timer with the unpack script
+	Nextion_PackField_t fields[NEX_PACK_FIELDS]; //added with NxHmi_PackField()
+	uint8_t count;
+	uint32_t sent[NEX_PACK_WORDS]; //last values of the variables
+	uint8_t sentValid; //bit mask of the variables with a known value on the display
+	uint16_t generation; //shadow generation of the sent values, see NxHmi_ShadowInvalidateAll()
+	uint32_t packedCnt; //updates sent packed
+	uint32_t fallbackCnt; //updates sent value by value
+} Nextion_Pack_t;
+
+
+typedef struct Nextion_DlItem_t {
+	Nx_Dl_Prim_t prim;
+	uint16_t arg[7]; //arguments in the order of the command
+} Nextion_DlItem_t;
+
+
+typedef struct Nextion_DisplayList_t {
+	Nextion_DlItem_t items[NEX_DL_ITEMS];
+	uint8_t count;
+	uint8_t overflow; //primitives have been dropped, the list was full
+	uint8_t code[NEX_DL_CODE_SIZE]; //compiled commands, with the terminators
+	uint16_t codeLength; //0 - not compiled yet
+	uint32_t optimizedCnt; //primitives removed or merged by the optimizer
+} Nextion_DisplayList_t;
+
+
+typedef struct Nextion_Mailbox_t {
+	Nextion_Object_t *pObject; //NULL if the slot is free
+	Nx_Shadow_Prop_t prop;
+	int32_t value;	//latest posted value
+	volatile uint8_t dirty;	//value is not sent yet
+	uint32_t seq;	//incremented at every post, a re-post is detected by it, not by the value
+
+} Nextion_Mailbox_t;
+
+
+typedef struct Nextion_TxBuffer_t {
+	uint8_t data[NEX_TX_BUFF_SIZE];
+	uint16_t length;
+	uint8_t overflow; //the command has been truncated by the encoder
+	uint8_t parts; //number of buffers of a long command, valid in the first buffer
+	uint8_t maxParts;
+	TickType_t xTicksToWait; //max. wait for the continuation buffers
+	struct Nextion_TxBuffer_t *pNext; //continuation of a long command, or NULL
+	TaskHandle_t xTaskToNotify; //task waiting for the end of transmission
+	Nextion_Token_t *pToken; //completion token of the command
+	Nx_Expect_t expect; //answer of the command
+	Nx_Pace_Class_t paceClass; //set by encodeEnd()
+	Nx_Tx_Lane_t lane; //scheduling class of the command
+	uint8_t cmdCount; //commands in the buffer, more than one for a display list
+	Nextion_Object_t *pShadowObject; //its shadow cache is settled by the answer, see shadowQueue(), or NULL
+	Nx_Shadow_Prop_t shadowProp;
+} Nextion_TxBuffer_t;
+
+
+typedef enum {
+	RX_STATE_HEAD = 0,	//waiting for the first byte of a frame
+	RX_STATE_FIXED,		//frame with a known length, e.g. 0x71 with a number, which can contain 0xFF
+	RX_STATE_TERMINATED,//frame ended by the terminator, e.g. 0x00
+	RX_STATE_STRING,	//0x70, the string goes straight into a block of the string arena
+	RX_STATE_RAW,		//raw number of an EXPECT_RAW request, 4 bytes without head and terminator
+	RX_STATE_SKIP		//broken frame, drop the bytes till the terminator
+} Nx_Rx_State_t;
+
+
+typedef struct Nextion_RxParser_t {
+	Nx_Rx_State_t state;
+	uint8_t frame[NEX_RX_FRAME_SIZE]; //received bytes of the frame, with the terminator
+	uint8_t length; //received bytes
+	uint8_t frameLength; //length of a fixed frame, with the terminator
+	uint8_t termCnt; //0xFF bytes at the end of the received bytes
+	char *pString; //arena block of the string under reception, NULL if none is free
+	uint16_t stringLength; //received bytes of the string, with the terminator
+} Nextion_RxParser_t;
+
+
+typedef struct Nextion_Expect_t {
+	Nx_Expect_t kind;
+	Nextion_Token_t *pToken; //NULL if nobody waits for the answer
+	Nx_Pace_Class_t paceClass;
+	TickType_t xTimeSent; //expected end of the transmission of the command
+	Nextion_Object_t *pShadowObject; //written object, its shadow cache is settled by the answer, or NULL
+	Nx_Shadow_Prop_t shadowProp;
+
+} Nextion_Expect_t;
+
+
+typedef struct Nextion_Touch_t {
+	uint32_t number; //1, 2, 3.. in the order of reception, a gap shows the dropped positions
+	TickType_t xTimeReceived;
+	uint16_t xCoordinate;
+	uint16_t yCoordinate;
+	uint8_t event; //NEX_EVENT_TOUCH or NEX_EVENT_RELEASE
+	uint8_t sleep; //1 - touched in sleep mode (0x68)
+
+} Nextion_Touch_t;
+
+
 typedef struct Nextion_HMI_Handler_t {
 	UART_HandleTypeDef *pUart;
 
 	uint8_t rxBuff[NEX_RX_BUFF_SIZE];
-	uint8_t rxCounter;
-	uint8_t rxPosition;
+	volatile uint32_t rxHead; //bytes received, free running, written by the RX events only
+	uint32_t rxTail; //bytes parsed, free running, written by the RX task only
+	uint16_t rxDmaPos; //write position of the DMA at the last RX event
+	volatile uint8_t rxIdle; //the last RX event was an idle line, not a half or full transfer
+	volatile uint8_t rxRestart; //restart the reception in the RX task: UART error or baud rate change
+	volatile uint8_t rxStartCnt; //restarts done by the RX task, free running
+	uint32_t rxOverrunCnt; //the parser fell behind the DMA, the unparsed bytes are dropped
+	Nextion_RxParser_t rxParser; //frame under reception, can be split across the RX events
 	uint16_t errorCnt;
 	uint16_t cmdCnt;
+	uint32_t truncatedCnt; //commands dropped, they have been truncated by the encoder
+	uint32_t elidedCnt; //writes skipped by the shadow cache
+	uint16_t shadowGeneration;
 	uint8_t ifaceVerbose;
 	NxCompRetStatus_t hmiStatus;
+	uint32_t baudDefault; //rate of the display after reset, saved by bauds=
+
+	///TX engine
+	Nextion_TxBuffer_t txBuffers[NEX_TX_BUFF_COUNT];
+	Nextion_TxBuffer_t *txBurstList[NEX_TX_BUFF_COUNT]; //buffers coalesced into the burst on the wire
+	uint8_t txBurstCount;
+	uint8_t txBurst[NEX_TX_BURST_SIZE];
+	uint16_t txBurstLength;
+	volatile uint8_t txLineBusy; //a burst is on the wire or the TX timer is running
+	uint32_t txByteCnt;
+	uint32_t txBurstCnt;
+	uint8_t txBurstCmdCount; //commands of the burst
+	uint8_t txBurstExpectCount; //commands of the burst in the expectation list
+	uint8_t txHoldLine; //the line is released by the TX timer (bkcmd < 3)
+	uint32_t txBurstPace; //expected processing time of the burst, in 1/2^NEX_PACE_FRAC_BITS ticks
+	Nextion_Lane_t txLanes[LANE_COUNT];
+	volatile uint8_t txTransparent; //addt is in progress, the line is locked until the data is done
+
+	///Dirty regions, drawn since the last repaint of the page
+	Nextion_Box_t dirtyRects[NEX_DIRTY_RECTS];
+	uint8_t dirtyCount;
+	Nx_Dirty_Bg_t dirtyBgMode;
+	uint16_t dirtyBgValue; //color or picture id
+	uint8_t currentPage; //last known page, 0xFF - unknown
+	Nextion_Footprint_t footprints[NEX_DIRTY_FOOTPRINTS];
+	uint32_t dirtyRepaintCnt; //regions repainted instead of ref 0
+
+	///Display-side macros
+	Nextion_Macro_t *macros[NEX_MACRO_SLOTS];
+
+	///String arena, blocks of the returned strings
+	char stringArena[NEX_STRING_BLOCKS][NEX_STRING_BLOCK_SIZE];
+	uint32_t stringFree; //bit mask of the free blocks
+	uint32_t stringDropCnt; //strings dropped (no free block) or truncated
+
+	///Touch stream, written by the RX task only
+	volatile uint32_t touchSeq; //odd while the last position is written
+	Nextion_Touch_t touchLast;
+	volatile uint32_t touchHead; //positions received, free running
+#if (NEX_TOUCH_HISTORY > 0)
+	Nextion_Touch_t touchHistory[NEX_TOUCH_HISTORY];
+	uint32_t touchTail; //positions read from the history, written by NxHmi_TouchRead() only
+	uint32_t touchDropCnt; //positions overwritten in the history before reading
+#endif
+
+	///Admission, wire-time budgets of the producer tasks
+	Nextion_Admit_t admit[NEX_ADMIT_TASKS];
+
+	///Waveform streaming
+	Nextion_WaveChannel_t waveChannels[NEX_WAVE_CHANNELS];
+
+	///Pacing, learned processing times
+	Nextion_Pace_t pace[PACE_CLASS_COUNT];
+	TickType_t paceLastAnswer;
+
+	///Pipeline, commands waiting for answer in the order of transmission
+	Nextion_Expect_t expectList[NEX_PIPELINE_DEPTH];
+	uint8_t expectHead;
+	volatile uint8_t expectCount;
+	uint32_t expectTimeoutCnt; //answers not arrived in NEX_ANSW_TIMEOUT
+
+	///Mailbox
+	Nextion_Mailbox_t mailbox[NEX_MAILBOX_SLOTS];
+	volatile uint8_t mailboxDirtyCnt;
+	uint8_t mailboxNext; //round robin start of the next collection
+	uint32_t mailboxDropCnt; //values overwritten before sending
 
 	///RTOS stuff
 	TaskHandle_t xTaskToNotify;
 	xTimerHandle blockTx;
-	xTimerHandle rxTimerHandle;
-	SemaphoreHandle_t hmiUartTxSem;
 	osMessageQueueId_t rxCommandQHandle;
 	osMessageQueueId_t objectQueueHandle;
+	osMessageQueueId_t txFreeQHandle;  //free TX buffers
+	xTimerHandle txGatherTimer;
+	xTimerHandle expectTimer;
 
 } Nextion_HMI_Handler_t;
 
@@ -173,7 +647,8 @@ typedef struct Ret_Command_t {
 	uint16_t xCoordinate;
 	uint16_t yCoordinate;
 	uint32_t numData;
-	char *stringData;
+	char *stringData; //borrowed block of the string arena, release it with NxHmi_ReleaseText()
+	uint16_t stringLength;
 
 }Ret_Command_t;
 
@@ -184,13 +659,125 @@ osThreadId_t hmiRxTaskHandle;
 
 ///Variables
 Nextion_HMI_Handler_t nextionHMI_h;
-char txBuf[30];
 
-void HmiSendCommand(const char *cmd);
 Ret_Status_t waitForAnswer(Ret_Command_t *pRetCommand);
-void rxTimerCallback(void *argument);
 void txTimerCallback(void *argument);
-void prepareToSend(uint8_t intInit);
+Nextion_TxBuffer_t *prepareToSend(uint8_t intInit);
+Ret_Status_t prepareToQueue(Nextion_TxBuffer_t **ppTxBuff, Nextion_Token_t *pToken);
+void HmiSendBuffer(Nextion_TxBuffer_t *pTxBuff);
+Ret_Status_t HmiSendAndWait(Nextion_TxBuffer_t *pTxBuff, Nx_Expect_t expect, Ret_Command_t *pRetCommand);
+Ret_Status_t HmiQueueBuffer(Nextion_TxBuffer_t *pTxBuff, Nextion_Token_t *pToken);
+Ret_Status_t HmiQueueBufferWait(Nextion_TxBuffer_t *pTxBuff, Nextion_Token_t *pToken);
+Ret_Status_t setObjectProp(Nextion_Object_t *pOb_handle, Nx_Shadow_Prop_t prop, int32_t value);
+Ret_Status_t setObjectPropAsync(Nextion_Object_t *pOb_handle, Nx_Shadow_Prop_t prop, int32_t value, Nextion_Token_t *pToken);
+
+//Command encoder, formats straight into a TX staging buffer
+Nextion_TxBuffer_t *encodeBegin(Nx_Tx_Lane_t lane, TickType_t xTicksToWait);
+void encodeLocal(Nextion_TxBuffer_t *pTxBuff);
+uint8_t encodeNameLength(Nextion_Object_t *pOb_handle);
+void encodeObjectProp(Nextion_TxBuffer_t *pTxBuff, Nextion_Object_t *pOb_handle, Nx_Shadow_Prop_t prop);
+void encodeText(Nextion_TxBuffer_t *pTxBuff, const char *text);
+void encodeTextEscaped(Nextion_TxBuffer_t *pTxBuff, const char *text, uint16_t length);
+void encodeChar(Nextion_TxBuffer_t *pTxBuff, char c);
+void encodeInt(Nextion_TxBuffer_t *pTxBuff, int32_t number);
+void encodeCommand(Nextion_TxBuffer_t *pTxBuff, const char *cmd, uint8_t argc, ...);
+void encodeEnd(Nextion_TxBuffer_t *pTxBuff);
+void encodeDiscard(Nextion_TxBuffer_t *pTxBuff);
+void encodeData(Nextion_TxBuffer_t *pTxBuff, const uint8_t *pData, uint16_t length);
+uint8_t formatUint(char *pDst, uint32_t number);
+uint8_t formatFixed(char *pDst, float number, uint8_t decimals);
+int32_t scaleFixed(float number, uint8_t decimals);
+
+//Shadow cache
+uint8_t shadowIsCached(Nextion_Object_t *pOb_handle, Nx_Shadow_Prop_t prop, uint32_t value);
+Ret_Status_t shadowUpdate(Nextion_Object_t *pOb_handle, Nx_Shadow_Prop_t prop, uint32_t value, Ret_Status_t status);
+void shadowQueue(Nextion_TxBuffer_t *pTxBuff, Nextion_Object_t *pOb_handle, Nx_Shadow_Prop_t prop, uint32_t value);
+void shadowSettle(Nextion_Object_t *pOb_handle, Nx_Shadow_Prop_t prop, Ret_Status_t status);
+uint32_t shadowHashText(const char *text);
+Ret_Status_t shadowSkipAsync(Nextion_Token_t *pToken);
+
+//Mailbox
+void mailboxInit(void);
+uint8_t mailboxCollect(uint8_t *pDst, uint16_t space, Nextion_TxBuffer_t *pCmd);
+
+//TX engine
+void txEngineInit(void);
+void txEngineSubmit(Nextion_TxBuffer_t *pTxBuff);
+void txEngineKick(void);
+void txEngineWake(void);
+void txEngineCompleteFromISR(BaseType_t *pxHigherPriorityTaskWoken);
+void txGatherTimerCallback(void *argument);
+Nx_Tx_Lane_t txEngineLane(void);
+Ret_Status_t txEngineTransparentStart(uint16_t length, Nextion_Token_t *pToken);
+void txEngineTransparentEnd(void);
+Ret_Status_t txEngineLock(TickType_t xTicksToWait);
+void txEngineUnlock(void);
+Ret_Status_t txEngineStreamBegin(uint16_t length, Nextion_Token_t *pToken);
+Ret_Status_t txEngineStreamWrite(const uint8_t *pData, uint16_t length);
+void txEngineStreamEnd(Ret_Status_t status);
+
+//Waveform streaming
+void waveInit(void);
+
+//Dirty regions
+void dirtyInit(void);
+void dirtyMark(const Nextion_Box_t *pBox);
+void dirtyMarkPrim(Nx_Dl_Prim_t prim, uint16_t arg0, uint16_t arg1, uint16_t arg2, uint16_t arg3);
+void dirtyReset(uint8_t pageId);
+void dlBounds(const Nextion_DlItem_t *pItem, Nextion_Box_t *pBox);
+
+//String arena
+void stringInit(void);
+char *stringAlloc(void);
+
+//Touch stream
+void touchInit(void);
+void touchPush(const uint8_t *cmdBuff);
+
+//Display-side macros
+void macroInit(void);
+Nextion_Macro_t *macroFind(Nx_Macro_Op_t op);
+uint8_t macroReady(const Nextion_Macro_t *pMacro);
+void macroEncodeTrigger(Nextion_TxBuffer_t *pTxBuff, const Nextion_Macro_t *pMacro);
+
+//Admission controller
+void admitInit(void);
+uint32_t admitCost(uint16_t length, Nx_Pace_Class_t paceClass);
+void admitWait(Nx_Tx_Lane_t lane);
+Ret_Status_t admitCommand(Nextion_TxBuffer_t *pTxBuff, uint8_t mayWait);
+Ret_Status_t admitCharge(Nx_Tx_Lane_t lane, uint32_t cost, uint8_t mayWait);
+void admitRefund(Nx_Tx_Lane_t lane, uint32_t cost);
+uint8_t admitCoalesce(Nextion_Object_t *pOb_handle);
+void tokenComplete(Nextion_Token_t *pToken, Ret_Status_t status);
+
+//Pipeline, expectation list of the commands in flight
+void expectInit(void);
+uint8_t expectFree(void);
+void expectPush(Nx_Expect_t kind, Nx_Pace_Class_t paceClass, Nextion_Token_t *pToken, TickType_t xTimeSent);
+void expectBindShadow(Nextion_Object_t *pOb_handle, Nx_Shadow_Prop_t prop);
+void expectDropLast(uint8_t count, Ret_Status_t status);
+uint8_t expectMatch(Ret_Command_t *pCommand);
+Nx_Expect_t expectNext(void);
+void expectResolveQuiet(void);
+void expectFlush(Ret_Status_t status);
+void expectTimerCallback(void *argument);
+
+//RX ring and protocol parser
+void rxStart(void);
+void rxProcess(void);
+char *rxTakeString(uint16_t *pLength);
+void validateCommand(const uint8_t *cmdBuff, uint8_t length);
+
+//Communication speed
+void comSpeedUart(uint32_t baud);
+
+//Pacing
+void paceInit(void);
+Nx_Pace_Class_t paceClassify(const uint8_t *pData, uint16_t length);
+uint32_t paceEstimate(Nx_Pace_Class_t paceClass);
+TickType_t paceBurstPeriod(uint32_t burstPace);
+TickType_t paceWireTicks(uint16_t bytes);
+void paceLearn(Nx_Pace_Class_t paceClass, TickType_t xTimeSent);
 
 	///Public function prototypes
 void NxHmi_Init(UART_HandleTypeDef *huart);
@@ -198,6 +785,55 @@ Ret_Status_t NxHmi_AddObject(Nextion_Object_t *pOb_handle);
 Ret_Status_t NxHmi_SetText(Nextion_Object_t *pOb_handle,const char *buffer);
 Ret_Status_t NxHmi_SetIntValue(Nextion_Object_t *pOb_handle, int16_t number);
 Ret_Status_t NxHmi_SetFloatValue(Nextion_Object_t *pOb_handle, float number);
+Ret_Status_t NxHmi_SetFloatValueDec(Nextion_Object_t *pOb_handle, float number, uint8_t decimals);
+Ret_Status_t NxHmi_SetXfloatValue(Nextion_Object_t *pOb_handle, float number, uint8_t decimals);
+Ret_Status_t NxHmi_SetXfloatFormat(Nextion_Object_t *pOb_handle, uint8_t intDigits, uint8_t decimals);
+Ret_Status_t NxHmi_SetLongText(Nextion_Object_t *pOb_handle, const char *text);
+
+//Shadow cache, skip writing values the display already shows
+void NxHmi_AttachShadow(Nextion_Object_t *pOb_handle, Nextion_Shadow_t *pShadow);
+void NxHmi_ShadowInvalidate(Nextion_Object_t *pOb_handle);
+void NxHmi_ShadowInvalidateAll(void);
+uint32_t NxHmi_GetElidedCount(void);
+
+//Admission, wire-time budget of the producer tasks
+Ret_Status_t NxHmi_SetTaskBudget(TaskHandle_t xTask, uint8_t sharePercent, Nx_Admit_Policy_t policy);
+const Nextion_Admit_t *NxHmi_GetAdmitTable(void);
+
+//Waveform streaming, samples are sent in addt transparent data blocks
+Ret_Status_t NxHmi_WaveStreamAdd(Nextion_Object_t *pOb_handle, uint8_t channel, uint8_t value);
+Ret_Status_t NxHmi_WaveStreamFlush(void);
+uint32_t NxHmi_GetWaveDropCount(void);
+
+//Mailbox, latest value wins, the newest value is sent when the line is free
+Ret_Status_t NxHmi_PostValue(Nextion_Object_t *pOb_handle, Nx_Shadow_Prop_t prop, int32_t value);
+Ret_Status_t NxHmi_PostIntValue(Nextion_Object_t *pOb_handle, int16_t number);
+uint32_t NxHmi_GetMailboxDropCount(void);
+
+//Touch stream, positions of sendxy=1 and the touches in sleep mode, read without blocking
+Ret_Status_t NxHmi_TouchLast(Nextion_Touch_t *pTouch);
+Ret_Status_t NxHmi_TouchRead(Nextion_Touch_t *pTouch);
+void NxHmi_TouchFlush(void);
+uint32_t NxHmi_GetTouchDropCount(void);
+
+//Async commands, return immediately, completion is reported through the token (can be NULL)
+void NxHmi_TokenInit(Nextion_Token_t *pToken, void (*callback)(Nextion_Token_t *pToken), void *pUserData);
+uint8_t NxHmi_TokenIsDone(Nextion_Token_t *pToken);
+Ret_Status_t NxHmi_TokenWait(Nextion_Token_t *pToken, TickType_t xTicksToWait);
+uint32_t NxHmi_GetAnswerTimeoutCount(void);
+uint32_t NxHmi_GetTruncatedCount(void);
+
+//Priority lanes of the TX scheduler, metrics
+const Nextion_Lane_t *NxHmi_GetLaneTable(void);
+uint8_t NxHmi_GetLaneDepth(Nx_Tx_Lane_t lane);
+
+//Adaptive pacing, the learned processing times of the command classes
+const Nextion_Pace_t *NxHmi_GetPaceTable(void);
+void NxHmi_SetPaceTime(Nx_Pace_Class_t paceClass, uint16_t timeMs);
+Ret_Status_t NxHmi_SetTextAsync(Nextion_Object_t *pOb_handle, const char *buffer, Nextion_Token_t *pToken);
+Ret_Status_t NxHmi_SetIntValueAsync(Nextion_Object_t *pOb_handle, int16_t number, Nextion_Token_t *pToken);
+Ret_Status_t NxHmi_SetFloatValueAsync(Nextion_Object_t *pOb_handle, float number, Nextion_Token_t *pToken);
+Ret_Status_t NxHmi_SetXfloatValueAsync(Nextion_Object_t *pOb_handle, float number, uint8_t decimals, Nextion_Token_t *pToken);
 
 //System commands
 void NxHmi_Verbosity(uint8_t vLevel);
@@ -205,14 +841,20 @@ Ret_Status_t NxHmi_SetBacklight(uint8_t value, Cnf_permanence_t cnfSave);
 Ret_Status_t NxHmi_SendXYcoordinates(uint8_t status);
 Ret_Status_t NxHmi_Sleep(uint8_t status);
 Ret_Status_t NxHmi_SetAutoSleep(uint16_t slNoSer, uint16_t slNoTouch, uint8_t wkpSer, uint8_t wkpTouch);
-//void NxHmi_ComSpeed(uint32_t baud, Cnf_permanence_t cnfSave);
+Ret_Status_t NxHmi_SetBacklightAsync(uint8_t value, Cnf_permanence_t cnfSave, Nextion_Token_t *pToken);
+Ret_Status_t NxHmi_ComSpeed(uint32_t baud, Cnf_permanence_t cnfSave);
+Ret_Status_t NxHmi_ComSpeedMax(uint32_t maxBaud, Cnf_permanence_t cnfSave);
 
 //Operational commands
 Ret_Status_t NxHmi_ForceRedrawComponent(Nextion_Object_t *pOb_handle);
 void NxHmi_CalibrateTouchSensor(void);
 Ret_Status_t NxHmi_GotoPage(uint8_t pageId);
 Ret_Status_t NxHmi_SetObjectVisibility(Nextion_Object_t *pOb_handle, Ob_visibility_t visible);
+Ret_Status_t NxHmi_SetObjectVisibilityAsync(Nextion_Object_t *pOb_handle, Ob_visibility_t visible, Nextion_Token_t *pToken);
 Ret_Status_t NxHmi_GetObjValue(Nextion_Object_t *pOb_handle, uint32_t *pValue);
+Ret_Status_t NxHmi_GetObjRawValue(Nextion_Object_t *pOb_handle, uint32_t *pValue);
+Ret_Status_t NxHmi_GetObjText(Nextion_Object_t *pOb_handle, const char **ppText, uint16_t *pLength);
+void NxHmi_ReleaseText(const char *pText);
 Ret_Status_t NxHmi_ResetDevice(void);
 Ret_Status_t NxHmi_GetCurrentPageId(uint8_t *pValue);
 void NxHmi_WaveFormAddValue(Nextion_Object_t *pOb_handle, uint8_t channel, uint8_t value);
@@ -221,6 +863,7 @@ Ret_Status_t NxHmi_WaveFormClearChannel(Nextion_Object_t *pOb_handle, uint8_t ch
 //GUI commands
 Ret_Status_t NxHmi_SetBcoColour(Nextion_Object_t *pOb_handle, uint16_t color);
 Ret_Status_t NxHmi_SetBcoColourRGB(Nextion_Object_t *pOb_handle, uint8_t red, uint8_t green, uint8_t blue);
+Ret_Status_t NxHmi_SetPcoColour(Nextion_Object_t *pOb_handle, uint16_t color);
 Ret_Status_t NxHmi_DrawImage(uint8_t picId, uint16_t xAxis, uint16_t yAxis);
 
 Ret_Status_t NxHmi_DrawCropImage(uint8_t picId, uint16_t xPane, uint16_t yPane,
@@ -233,6 +876,59 @@ Ret_Status_t NxHmi_DrawRect(uint16_t startX, uint16_t startY, uint16_t endX,
 
 Ret_Status_t NxHmi_DrawCircle(uint16_t centX, uint16_t centY, uint16_t radius, uint16_t color, uint8_t fMode);
 
+Ret_Status_t NxHmi_SetBcoColourAsync(Nextion_Object_t *pOb_handle, uint16_t color, Nextion_Token_t *pToken);
+Ret_Status_t NxHmi_SetBcoColourRGBAsync(Nextion_Object_t *pOb_handle, uint8_t red, uint8_t green, uint8_t blue,
+											Nextion_Token_t *pToken);
+Ret_Status_t NxHmi_SetPcoColourAsync(Nextion_Object_t *pOb_handle, uint16_t color, Nextion_Token_t *pToken);
+Ret_Status_t NxHmi_DrawImageAsync(uint8_t picId, uint16_t xAxis, uint16_t yAxis, Nextion_Token_t *pToken);
+
+Ret_Status_t NxHmi_DrawCropImageAsync(uint8_t picId, uint16_t xPane, uint16_t yPane, uint16_t width,
+									uint16_t height, uint16_t xImg, uint16_t yImg, Nextion_Token_t *pToken);
+
+Ret_Status_t NxHmi_DrawLineAsync(uint16_t startX, uint16_t startY, uint16_t endX, uint16_t endY,
+									uint16_t color, Nextion_Token_t *pToken);
+
+Ret_Status_t NxHmi_DrawRectAsync(uint16_t startX, uint16_t startY, uint16_t endX, uint16_t endY,
+									uint16_t color, uint8_t fMode, Nextion_Token_t *pToken);
+
+Ret_Status_t NxHmi_DrawCircleAsync(uint16_t centX, uint16_t centY, uint16_t radius, uint16_t color,
+									uint8_t fMode, Nextion_Token_t *pToken);
+
+//Display list, primitives recorded, optimized and sent in one burst
+void NxHmi_DlClear(Nextion_DisplayList_t *pList);
+Ret_Status_t NxHmi_DlFill(Nextion_DisplayList_t *pList, uint16_t xAxis, uint16_t yAxis,
+									uint16_t width, uint16_t height, uint16_t color);
+Ret_Status_t NxHmi_DlRect(Nextion_DisplayList_t *pList, uint16_t startX, uint16_t startY,
+									uint16_t endX, uint16_t endY, uint16_t color);
+Ret_Status_t NxHmi_DlLine(Nextion_DisplayList_t *pList, uint16_t startX, uint16_t startY,
+									uint16_t endX, uint16_t endY, uint16_t color);
+Ret_Status_t NxHmi_DlCircle(Nextion_DisplayList_t *pList, uint16_t centX, uint16_t centY,
+									uint16_t radius, uint16_t color, uint8_t fMode);
+Ret_Status_t NxHmi_DlImage(Nextion_DisplayList_t *pList, uint8_t picId, uint16_t xAxis, uint16_t yAxis);
+Ret_Status_t NxHmi_DlCropImage(Nextion_DisplayList_t *pList, uint8_t picId, uint16_t xPane, uint16_t yPane,
+									uint16_t width, uint16_t height, uint16_t xImg, uint16_t yImg);
+Ret_Status_t NxHmi_DlCompile(Nextion_DisplayList_t *pList);
+Ret_Status_t NxHmi_DlSubmit(Nextion_DisplayList_t *pList);
+Ret_Status_t NxHmi_DlReplay(const Nextion_DisplayList_t *pList);
+
+//Dirty regions, repainted instead of the full page
+void NxHmi_DirtySetBackground(uint16_t color);
+void NxHmi_DirtySetBackgroundPic(uint8_t picId);
+void NxHmi_DirtyAdd(uint16_t xAxis, uint16_t yAxis, uint16_t width, uint16_t height);
+Ret_Status_t NxHmi_SetFootprint(Nextion_Object_t *pOb_handle, uint16_t xAxis, uint16_t yAxis,
+									uint16_t width, uint16_t height);
+Ret_Status_t NxHmi_DirtyRepaint(void);
+
+//Display-side macros, command sequences run by a script of the HMI project
+Ret_Status_t NxHmi_MacroRegister(Nextion_Macro_t *pMacro);
+Ret_Status_t NxHmi_MacroVerify(Nextion_Macro_t *pMacro);
+Ret_Status_t NxHmi_MacroRun(Nextion_Macro_t *pMacro, uint8_t argc, const int32_t *pArgs);
+
+
+//Packed updates, several numeric values in global variables, unpacked by a script of the HMI project
+Ret_Status_t NxHmi_PackField(Nextion_Pack_t *pPack, Nextion_Object_t *pOb_handle, uint8_t bits);
+Ret_Status_t NxHmi_PackUpdate(Nextion_Pack_t *pPack, const int32_t *pValues);
+uint16_t NxHmi_PackScript(const Nextion_Pack_t *pPack, char *pDst, uint16_t size);
 
 #ifdef __cplusplus
 }
@@ -36,10 +36,8 @@ const osMessageQueueAttr_t txObjQ_attributes = {
 void ObjectHandlerTask(void *argument);
 void StartHmiRxTask(void *argument);
 
-static int8_t HmiCmdFromStream(uint8_t *buff, uint8_t buffSize);
-static void validateCommand(uint8_t *cmdBuff);
 static void findObject(uint8_t pid, uint8_t cid, uint8_t event);
-static int8_t isItRawData(void);
+static Ret_Status_t queueBuffer(Nextion_TxBuffer_t *pTxBuff, Nextion_Token_t *pToken, uint8_t mayWait);
 
 //|||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||
 
@@ -49,16 +47,12 @@ void ObjectHandlerTask(void *argument) {
 	Ret_Command_t objCommand;
 	//Always perform a display reset
 	NxHmi_ResetDevice();
-	//NxHmi_Verbosity(3);
 	nextionHMI_h.errorCnt = 0;
   for(;;) {
 	  	  // Block until an command arrives
 	  if(xQueueReceive(nextionHMI_h.objectQueueHandle, &objCommand, portMAX_DELAY) == pdPASS) {
 		  //Successfully received a command
-		  //Wait for the response in progress
-		  while(nextionHMI_h.hmiStatus != COMP_IDLE) {
-			  vTaskDelay(5);
-		  }
+		  //The commands of the callback go to the interactive lane, no need to wait for the line
 		  //Lookup in object array for the received command and call the corresponding function
 		  findObject(objCommand.pageId, objCommand.cmpntId, objCommand.event);
 	  }//end if
@@ -69,22 +63,22 @@ void ObjectHandlerTask(void *argument) {
 /* FreeRTOS Task HmiRx*/
 void StartHmiRxTask(void *argument) {
 
-	uint8_t commandBuffer[20];
-	int8_t retAnswer = 0;
-
-	HAL_UART_Receive_IT(nextionHMI_h.pUart, &nextionHMI_h.rxBuff[nextionHMI_h.rxCounter], 1);
+	rxStart();
 
   /* Infinite loop */
   for(;;) {
 
-	  /* Block indefinitely until a Serial data arrives or query timeouts*/
+	  /* Block indefinitely until an RX event (idle line, half or full ring) arrives */
 	  ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
-	  	  //loop thru RX buffer until no more data left or error occurs
-	  do{
-		  retAnswer = HmiCmdFromStream(commandBuffer, sizeof(commandBuffer) );
-		  validateCommand(commandBuffer);
-		  memset(&commandBuffer, BUFF_CLEAR_PATTERN, sizeof(commandBuffer));
-	  }while(retAnswer > 0);//end while loop
+	  if(nextionHMI_h.rxRestart) {
+		  //The reception has been stopped by an UART error, or the baud rate has been changed
+		  nextionHMI_h.rxRestart = 0;
+		  rxStart();
+		  nextionHMI_h.rxStartCnt++;
+		  continue;
+	  }
+	  	  //parse the received bytes, the completed frames are validated right away
+	  rxProcess();
   }//end for loop
 }
 //|||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||
@@ -98,12 +92,19 @@ void StartHmiRxTask(void *argument) {
  */
 void NxHmi_Init(UART_HandleTypeDef *huart) {
 	nextionHMI_h.pUart = huart;
-	nextionHMI_h.rxCounter = 0;
-	nextionHMI_h.rxPosition = 0;
+	nextionHMI_h.rxHead = 0;
+	nextionHMI_h.rxTail = 0;
+	nextionHMI_h.rxRestart = 0;
+	nextionHMI_h.rxStartCnt = 0;
+	nextionHMI_h.rxOverrunCnt = 0;
 	nextionHMI_h.errorCnt = 0;
 	nextionHMI_h.cmdCnt = 0;
+	nextionHMI_h.truncatedCnt = 0;
+	nextionHMI_h.elidedCnt = 0;
+	nextionHMI_h.shadowGeneration = 0;
 	nextionHMI_h.ifaceVerbose = 2; // default is level 2, return data On Failure
 	nextionHMI_h.hmiStatus = COMP_INVALID;
+	nextionHMI_h.baudDefault = huart->Init.BaudRate;
 	nextionHMI_h.xTaskToNotify = NULL;  // no task is waiting
 
 	  /* creation of hmiTasks */
@@ -115,12 +116,6 @@ void NxHmi_Init(UART_HandleTypeDef *huart) {
 	  nextionHMI_h.objectQueueHandle = osMessageQueueNew (4, sizeof(Ret_Command_t), &txObjQ_attributes);
 
 	  /* creation of timers */
-	  nextionHMI_h.rxTimerHandle = xTimerCreate("RxTimer",         // Just a text name, not used by the kernel.
-		  	  	  	  	  	  	  	TOUT_PERIOD_CALC(nextionHMI_h.pUart->Init.BaudRate) , // The timer period in ticks.
-                                    pdFALSE,         // One-shot timer, enter a dormant state after it expires.
-									( void * )0,     // Assign each timer a unique id equal to its array index.
-                                    (TimerCallbackFunction_t) rxTimerCallback     // Timer callback when it expires.
-                                    );
 	  /* creation of TX timer */
 	  nextionHMI_h.blockTx = xTimerCreate("TxTimer",         // Just a text name, not used by the kernel.
 		  	  	  	  	  	  	  	TOUT_PERIOD_CALC(nextionHMI_h.pUart->Init.BaudRate) , // The minimum time between sending commands
@@ -129,16 +124,23 @@ void NxHmi_Init(UART_HandleTypeDef *huart) {
                                     (TimerCallbackFunction_t) txTimerCallback	  // Timer callback when it expires.
                                     );
 
-	  /* creation of semaphore */
-	  nextionHMI_h.hmiUartTxSem = xSemaphoreCreateBinary();
-
-	  xSemaphoreGive(nextionHMI_h.hmiUartTxSem);
+	  /* creation of TX buffer pool */
+	  mailboxInit();
+	  admitInit();
+	  waveInit();
+	  dirtyInit();
+	  macroInit();
+	  stringInit();
+	  touchInit();
+	  txEngineInit();
+	  expectInit();
+	  paceInit();
 
 }
 
 /**
  * @brief Add Nextion objects to object array .
- * @note
+ * @note  The object must be static or zero initialized, see Nextion_Object_t
  *
  * @param *pOb_handle  Nextion object
  * @retval 0-failed, 1-success
@@ -147,6 +149,8 @@ Ret_Status_t NxHmi_AddObject(Nextion_Object_t *pOb_handle) {
 	if (Nextion_Object_Count < NEX_MAX_OBJECTS) {
 		Nextion_Object_List[Nextion_Object_Count] = pOb_handle;
 		Nextion_Object_Count++;
+		//Cache the prefix length for the command encoder
+		encodeNameLength(pOb_handle);
 
 		return STAT_OK;
 	}
@@ -158,19 +162,26 @@ Ret_Status_t NxHmi_AddObject(Nextion_Object_t *pOb_handle) {
 
 /**
  * @brief Set text for txt type of Nextion object
- * @note  Send text
+ * @note  Send text, it must fit into NEX_TX_CHAIN_MAX staging buffers. Not escaped,
+ * 		  for longer or quoted texts use NxHmi_SetLongText()
  *
  * @param *pOb_handle = Nextion object handler
  * @param *buffer = string pointer
- * @retval see @ref waitForAnswer() function for return value
+ * @retval see @ref HmiSendAndWait() function for return value
  */
 Ret_Status_t NxHmi_SetText(Nextion_Object_t *pOb_handle, const char *buffer) {
 
-	prepareToSend(0);
-	sprintf(txBuf, "%s.txt=\"%s\"", pOb_handle->Name, buffer);
-	HmiSendCommand(txBuf);
+	uint32_t textHash = shadowHashText(buffer);
+	if(shadowIsCached(pOb_handle, SHADOW_TXT, textHash)) {
+		return STAT_OK;
+	}
 
-	return waitForAnswer(NULL);
+	Nextion_TxBuffer_t *pTxBuff = prepareToSend(0);
+	encodeObjectProp(pTxBuff, pOb_handle, SHADOW_TXT);
+	encodeText(pTxBuff, buffer);
+	encodeChar(pTxBuff, '"');
+	shadowQueue(pTxBuff, pOb_handle, SHADOW_TXT, textHash);
+	return HmiSendAndWait(pTxBuff, EXPECT_ACK, NULL);
 }
 
 /**
@@ -179,32 +190,223 @@ Ret_Status_t NxHmi_SetText(Nextion_Object_t *pOb_handle, const char *buffer) {
  *
  * @param *pOb_handle = Nextion object handler
  * @param number = integer
- * @retval see @ref waitForAnswer() function for return value
+ * @retval see @ref HmiSendAndWait() function for return value
  */
 Ret_Status_t NxHmi_SetIntValue(Nextion_Object_t *pOb_handle, int16_t number) {
 
-	prepareToSend(0);
-	sprintf(txBuf, "%s.val=%i", pOb_handle->Name, number);
-	HmiSendCommand(txBuf);
-
-	return waitForAnswer(NULL);
+	return setObjectProp(pOb_handle, SHADOW_VAL, number);
 }
 
 /**
- * @brief Set float number for int type of Nextion object
- * @note  Send float number
+ * @brief Set float number for txt type of Nextion object
+ * @note  Send float number as text, with NEX_FLOAT_DECIMALS decimals
  *
  * @param *pOb_handle = Nextion object handler
  * @param number = float number
- * @retval see @ref waitForAnswer() function for return value
+ * @retval see @ref HmiSendAndWait() function for return value
  */
 Ret_Status_t NxHmi_SetFloatValue( Nextion_Object_t *pOb_handle, float number) {
 
-	prepareToSend(0);
-	sprintf(txBuf, "%s.txt=\"%.2f\"", pOb_handle->Name, number);
-	HmiSendCommand(txBuf);
+	return NxHmi_SetFloatValueDec(pOb_handle, number, NEX_FLOAT_DECIMALS);
+}
+
+/**
+ * @brief Set float number for txt type of Nextion object
+ * @note  Send float number as text, rounded to the given decimals.
+ * 		  Formatted without printf, "Use float with printf" is not required.
+ *
+ * @param *pOb_handle = Nextion object handler
+ * @param number = float number
+ * @param decimals = number of decimals, max. NEX_FLOAT_MAX_DECIMALS
+ * @retval see @ref HmiSendAndWait() function for return value
+ */
+Ret_Status_t NxHmi_SetFloatValueDec(Nextion_Object_t *pOb_handle, float number, uint8_t decimals) {
+
+	char numText[NEX_FLOAT_TEXT_SIZE];
+	formatFixed(numText, number, decimals);
+
+	return NxHmi_SetText(pOb_handle, numText);
+}
+
+/**
+ * @brief Set float number for Xfloat type of Nextion object
+ * @note  The number is sent as a scaled integer to .val, the display places the decimal point.
+ * 		  The decimals must match the vvs1 attribute of the component, see NxHmi_SetXfloatFormat()
+ *
+ * @param *pOb_handle = Nextion object handler
+ * @param number = float number
+ * @param decimals = number of decimals, max. NEX_FLOAT_MAX_DECIMALS
+ * @retval see @ref HmiSendAndWait() function for return value
+ */
+Ret_Status_t NxHmi_SetXfloatValue(Nextion_Object_t *pOb_handle, float number, uint8_t decimals) {
+
+	return setObjectProp(pOb_handle, SHADOW_VAL, scaleFixed(number, decimals));
+}
+
+/**
+ * @brief Set the number format of an Xfloat type of Nextion object
+ * @note  Set the vvs0 and vvs1 attributes, it's enough to do it once, or set them in the editor
+ *
+ * @param *pOb_handle = Nextion object handler
+ * @param intDigits = number of integer digits (vvs0), 0 - automatic
+ * @param decimals = number of decimals (vvs1)
+ * @retval see @ref HmiSendAndWait() function for return value
+ */
+Ret_Status_t NxHmi_SetXfloatFormat(Nextion_Object_t *pOb_handle, uint8_t intDigits, uint8_t decimals) {
+
+	Ret_Status_t tmpRet;
+	Nextion_TxBuffer_t *pTxBuff = prepareToSend(0);
+	encodeText(pTxBuff, pOb_handle->Name);
+	encodeText(pTxBuff, ".vvs0=");
+	encodeInt(pTxBuff, intDigits);
+	tmpRet = HmiSendAndWait(pTxBuff, EXPECT_ACK, NULL);
+	if(tmpRet != STAT_OK) {
+		return tmpRet;
+	}
+
+	pTxBuff = prepareToSend(0);
+	encodeText(pTxBuff, pOb_handle->Name);
+	encodeText(pTxBuff, ".vvs1=");
+	encodeInt(pTxBuff, decimals);
+	return HmiSendAndWait(pTxBuff, EXPECT_ACK, NULL);
+}
+
+/**
+ * @brief Set text for txt type of Nextion object, without waiting
+ * @note  Async version of NxHmi_SetText()
+ *
+ * @param *pOb_handle = Nextion object handler
+ * @param *buffer = string pointer
+ * @param *pToken = completion token, NULL if not required
+ * @retval 	STAT_ERROR 		= display is not ready
+ * 			STAT_TIMEOUT	= no free TX buffer, command dropped
+ * 			STAT_OK 		= command is queued
+ */
+Ret_Status_t NxHmi_SetTextAsync(Nextion_Object_t *pOb_handle, const char *buffer, Nextion_Token_t *pToken) {
+
+	uint32_t textHash = shadowHashText(buffer);
+	if(shadowIsCached(pOb_handle, SHADOW_TXT, textHash)) {
+		return shadowSkipAsync(pToken);
+	}
+
+	Nextion_TxBuffer_t *pTxBuff;
+
+	if(prepareToQueue(&pTxBuff, pToken) != STAT_OK) {
+		return STAT_ERROR;
+	}
+	encodeObjectProp(pTxBuff, pOb_handle, SHADOW_TXT);
+	encodeText(pTxBuff, buffer);
+	encodeChar(pTxBuff, '"');
+	//The cache is settled by the answer
+	shadowQueue(pTxBuff, pOb_handle, SHADOW_TXT, textHash);
+
+	return HmiQueueBuffer(pTxBuff, pToken);
+}
+
+/**
+ * @brief Set integer number for int type of Nextion object, without waiting
+ * @note  Async version of NxHmi_SetIntValue()
+ *
+ * @param *pOb_handle = Nextion object handler
+ * @param number = integer
+ * @param *pToken = completion token, NULL if not required
+ * @retval see @ref NxHmi_SetTextAsync() function for return value
+ */
+Ret_Status_t NxHmi_SetIntValueAsync(Nextion_Object_t *pOb_handle, int16_t number, Nextion_Token_t *pToken) {
+
+	return setObjectPropAsync(pOb_handle, SHADOW_VAL, number, pToken);
+}
+
+/**
+ * @brief Set float number for int type of Nextion object, without waiting
+ * @note  Async version of NxHmi_SetFloatValue()
+ *
+ * @param *pOb_handle = Nextion object handler
+ * @param number = float number
+ * @param *pToken = completion token, NULL if not required
+ * @retval see @ref NxHmi_SetTextAsync() function for return value
+ */
+Ret_Status_t NxHmi_SetFloatValueAsync(Nextion_Object_t *pOb_handle, float number, Nextion_Token_t *pToken) {
+
+	char numText[NEX_FLOAT_TEXT_SIZE];
+	formatFixed(numText, number, NEX_FLOAT_DECIMALS);
+
+	return NxHmi_SetTextAsync(pOb_handle, numText, pToken);
+}
+
+/**
+ * @brief Set float number for Xfloat type of Nextion object, without waiting
+ * @note  Async version of NxHmi_SetXfloatValue()
+ *
+ * @param *pOb_handle = Nextion object handler
+ * @param number = float number
+ * @param decimals = number of decimals, max. NEX_FLOAT_MAX_DECIMALS
+ * @param *pToken = completion token, NULL if not required
+ * @retval see @ref NxHmi_SetTextAsync() function for return value
+ */
+Ret_Status_t NxHmi_SetXfloatValueAsync(Nextion_Object_t *pOb_handle, float number, uint8_t decimals, Nextion_Token_t *pToken) {
+
+	return setObjectPropAsync(pOb_handle, SHADOW_VAL, scaleFixed(number, decimals), pToken);
+}
+
+/**
+ * @brief Set a numeric property of a Nextion object
+ * @note  Common part of the numeric setters, skip the write if the shadow cache has the value
+ *
+ * @param *pOb_handle = Nextion object handler
+ * @param prop = property of the object, except SHADOW_TXT
+ * @param value = new value
+ * @retval see @ref HmiSendAndWait() function for return value
+ */
+Ret_Status_t setObjectProp(Nextion_Object_t *pOb_handle, Nx_Shadow_Prop_t prop, int32_t value) {
+
+	if(shadowIsCached(pOb_handle, prop, (uint32_t)value)) {
+		return STAT_OK;
+	}
+	if(admitCoalesce(pOb_handle)) {
+		//Over budget, only the newest value is sent
+		return NxHmi_PostValue(pOb_handle, prop, value);
+	}
+
+	Nextion_TxBuffer_t *pTxBuff = prepareToSend(0);
+	encodeObjectProp(pTxBuff, pOb_handle, prop);
+	encodeInt(pTxBuff, value);
+	shadowQueue(pTxBuff, pOb_handle, prop, (uint32_t)value);
+	return HmiSendAndWait(pTxBuff, EXPECT_ACK, NULL);
+}
+
+/**
+ * @brief Set a numeric property of a Nextion object, without waiting
+ * @note  Async version of setObjectProp()
+ *
+ * @param *pOb_handle = Nextion object handler
+ * @param prop = property of the object, except SHADOW_TXT
+ * @param value = new value
+ * @param *pToken = completion token, NULL if not required
+ * @retval see @ref NxHmi_SetTextAsync() function for return value
+ */
+Ret_Status_t setObjectPropAsync(Nextion_Object_t *pOb_handle, Nx_Shadow_Prop_t prop, int32_t value, Nextion_Token_t *pToken) {
 
-	return waitForAnswer(NULL);
+	if(shadowIsCached(pOb_handle, prop, (uint32_t)value)) {
+		return shadowSkipAsync(pToken);
+	}
+	if(admitCoalesce(pOb_handle)) {
+		//Over budget, only the newest value is sent, no answer is reported
+		shadowSkipAsync(pToken);
+		return NxHmi_PostValue(pOb_handle, prop, value);
+	}
+
+	Nextion_TxBuffer_t *pTxBuff;
+
+	if(prepareToQueue(&pTxBuff, pToken) != STAT_OK) {
+		return STAT_ERROR;
+	}
+	encodeObjectProp(pTxBuff, pOb_handle, prop);
+	encodeInt(pTxBuff, value);
+	//The cache is settled by the answer
+	shadowQueue(pTxBuff, pOb_handle, prop, (uint32_t)value);
+
+	return HmiQueueBuffer(pTxBuff, pToken);
 }
 
 /**
@@ -301,106 +503,20 @@ static void findObject(uint8_t pid, uint8_t cid, uint8_t event) {
 	}//end for loop
 }
 
-/**
- * @brief Search for return value or event from Nextion display
- * @note  Static function, intended for internal task
- *
- * @param *buff = Pointer for the (RX) incoming data buffer
- * @param buffSize = Amount of incoming data
- * @retval int8_t = 0-No more data, 1-More data in the stream, <0 -Error
- */
-static int8_t HmiCmdFromStream(uint8_t *buff, uint8_t buffSize) {
-
-	HAL_UART_AbortReceive_IT(nextionHMI_h.pUart);
-	memset(buff, BUFF_CLEAR_PATTERN, buffSize);
-
-	uint8_t termPatternCnt = 0;
-	uint8_t isRawData = 0;
-	uint8_t helper = nextionHMI_h.rxPosition;
-
-	isRawData = isItRawData();
-
-	if(isRawData == 0) {
-		//loop till end of stream
-		for(; nextionHMI_h.rxPosition < nextionHMI_h.rxCounter; nextionHMI_h.rxPosition++) {
-			//if found termination character, break the loop
-			if(nextionHMI_h.rxBuff[nextionHMI_h.rxPosition] == 0xFF) {
-				break;
-			} else {
-				if((nextionHMI_h.rxPosition - helper) < buffSize) {
-					//copy serial stream to command buffer
-					buff[nextionHMI_h.rxPosition - helper] = nextionHMI_h.rxBuff[nextionHMI_h.rxPosition];
-				} else {
-					//buffer overflow, TODO: drop everything?
-					memset(buff, BUFF_CLEAR_PATTERN, buffSize);
-					nextionHMI_h.errorCnt++;
-					return -3;
-				}//end if
-
-			} //end if 0xFF
-		}//end for loop
-
-		//count the terminator characters (Nextion always send 3 pcs)
-		for( ; nextionHMI_h.rxBuff[nextionHMI_h.rxPosition] == 0xFF ; ) {
-			//if we have reached the end of the stream
-			if( (nextionHMI_h.rxPosition) >= nextionHMI_h.rxCounter) {
-				break;
-			}
-			nextionHMI_h.rxPosition++;
-			termPatternCnt++;
-		}//end for loop
-
-	} else {
-		//Raw data
-		buff[0] = NEX_RET_NUMBER_HEAD;
-		for(uint8_t i = 0; i < 4; i++){
-			buff[i+1] = nextionHMI_h.rxBuff[i];
-		}//end for loop
-		nextionHMI_h.rxPosition += 4;
-	}//else raw data checking
-
-	if( nextionHMI_h.rxPosition >= nextionHMI_h.rxCounter ) {
-		//Reach the end
-		nextionHMI_h.rxPosition = nextionHMI_h.rxCounter = 0;
-		//to store data at beginning of the buffer
-		//HAL_UART_AbortReceive_IT(nextionHMI_h.pUart);
-		memset(nextionHMI_h.rxBuff, BUFF_CLEAR_PATTERN, NEX_RX_BUFF_SIZE);
-		HAL_UART_Receive_IT(nextionHMI_h.pUart, &nextionHMI_h.rxBuff[nextionHMI_h.rxCounter], 1);
-
-		if(termPatternCnt == 3 || (isRawData == 1) ) {
-			nextionHMI_h.cmdCnt++;
-			return 0; //no more data
-		} else {
-			nextionHMI_h.errorCnt++;
-			return -2; // error
-		}
-
-	} else {
-		//More data in the buffer
-		if(termPatternCnt == 3 || (isRawData == 1)) {
-			nextionHMI_h.cmdCnt++;
-			return 1; //there is more data in the RX buffer
-		} else {
-			nextionHMI_h.errorCnt++;
-			return -1; // more data and error
-		}
-	}
-
-}
-
 /**
  * @brief Parse incoming event from Nextion display
- * @note  Static function, intended for internal task
+ * @note  Called by the protocol parser of the RX task, see rxProcess()
  *
- * @param *cmdBuff = Pointer for the (RX) incoming data buffer
+ * @param *cmdBuff = Pointer for the received frame, without the terminator
+ * @param length = length of the frame, the fixed frames are complete
  * @retval void
  */
-static void validateCommand(uint8_t *cmdBuff) {
+void validateCommand(const uint8_t *cmdBuff, uint8_t length) {
 	Ret_Command_t command;
 	memset(&command, 0x00, sizeof(Ret_Command_t));
 	uint8_t sendQueue = 1;
 
-	if(cmdBuff[0] == 0x00 && cmdBuff[1] == BUFF_CLEAR_PATTERN ) {
+	if(cmdBuff[0] == 0x00 && length == 1 ) {
 		//Invalid instruction
 		command.cmdCode = 0x00;
 		nextionHMI_h.errorCnt++;
@@ -424,6 +540,11 @@ static void validateCommand(uint8_t *cmdBuff) {
 				command.cmdCode = cmdBuff[0];
 				break;
 
+			case NEX_EVENT_TRANSPARENT_READY:
+			case NEX_EVENT_TRANSPARENT_DONE:
+				command.cmdCode = cmdBuff[0];
+				break;
+
 			case NEX_EVENT_TOUCH_HEAD:
 				command.cmdCode = cmdBuff[0];
 				command.pageId = cmdBuff[1];
@@ -434,10 +555,10 @@ static void validateCommand(uint8_t *cmdBuff) {
 				break;
 
 			case NEX_EVENT_POSITION_HEAD:
-				command.cmdCode = cmdBuff[0];
-				command.xCoordinate = (cmdBuff[1] << 0) | (cmdBuff[2] << 8);
-				command.yCoordinate = (cmdBuff[3] << 0) | (cmdBuff[4] << 8);
-				command.event = cmdBuff[5];
+			case NEX_EVENT_SLEEP_POSITION_HEAD:
+				//Touch stream, not an answer, the positions don't go to the command queue
+				touchPush(cmdBuff);
+				sendQueue = 0;
 				break;
 
 			case NEX_RET_CURRENT_PAGEID_HEAD:
@@ -447,6 +568,7 @@ static void validateCommand(uint8_t *cmdBuff) {
 
 			case NEX_RET_STRING_HEAD:
 				command.cmdCode = cmdBuff[0];
+				command.stringData = rxTakeString(&command.stringLength);
 				break;
 
 			case NEX_RET_NUMBER_HEAD:
@@ -462,6 +584,15 @@ static void validateCommand(uint8_t *cmdBuff) {
 		}//end switch
 	}//end if
 
+	if(sendQueue && expectMatch(&command)) {
+		//The frame answered a command in flight
+		sendQueue = 0;
+	} else if(command.stringData != NULL) {
+		//Unsolicited string, nobody would release it
+		NxHmi_ReleaseText(command.stringData);
+		command.stringData = NULL;
+	}
+
 	if(sendQueue) {
 		xQueueSend(nextionHMI_h.rxCommandQHandle, &command, NEX_QUEUE_TIMEOUT);
 		if(uxQueueSpacesAvailable(nextionHMI_h.rxCommandQHandle) == 0) {
@@ -478,76 +609,175 @@ static void validateCommand(uint8_t *cmdBuff) {
 }
 
 /**
- * @brief Attach the terminating characters at the end of the command string
- * @note  Static function, intended for internal task
+ * @brief Terminate an encoded command and send it
+ * @note  Block the task until the command has been transmitted.
+ * 		  The answer is not matched, read it with waitForAnswer() (reset procedure).
  *
- * @param *cmd = command string value
+ * @param *pTxBuff = staging buffer from prepareToSend()
  * @retval void
  */
-void HmiSendCommand(const char *cmd) {
+void HmiSendBuffer(Nextion_TxBuffer_t *pTxBuff) {
 
-    char term[4] = {0xFF, 0xFF, 0xFF, 0x00};
+	encodeEnd(pTxBuff);
+	pTxBuff->expect = EXPECT_NONE;
+	pTxBuff->xTaskToNotify = xTaskGetCurrentTaskHandle();
+	//Start data transmission or queue it behind the active one
+	txEngineSubmit(pTxBuff);
+	//Block the task until data has been transmitted
+	ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
 
-	sprintf(txBuf, "%s%s", cmd, term);
+}
 
-    //Start data transmission
-    HAL_UART_Transmit_IT(nextionHMI_h.pUart,(uint8_t*)txBuf, strlen(txBuf) );
-    //Block the task until data has been transmitted
-    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+/**
+ * @brief Terminate an encoded command and queue it
+ * @note  Returns without waiting for the transmission. Queued commands are coalesced into one burst.
+ * 		  The token is completed when the display has processed the command.
+ * 		  It never sleeps, over the budget of the task the command is dropped.
+ *
+ * @param *pTxBuff = staging buffer from encodeBegin(), NULL if no buffer was available
+ * @param *pToken = completion token, NULL if not required
+ * @retval 	STAT_TIMEOUT	= no free TX buffer, the command is dropped
+ * 			STAT_ERROR		= the command has been truncated by the encoder, it's dropped
+ * 			STAT_BUSY		= the task is over its wire-time budget, the command is dropped
+ * 			STAT_OK 		= command is queued
+ */
+Ret_Status_t HmiQueueBuffer(Nextion_TxBuffer_t *pTxBuff, Nextion_Token_t *pToken) {
+	return queueBuffer(pTxBuff, pToken, 0);
+}
 
+/**
+ * @brief Terminate an encoded command and queue it, for the blocking calls
+ * @note  Same as HmiQueueBuffer(), but over budget with ADMIT_DEFER or ADMIT_COALESCE
+ * 		  the command is admitted, prepareToSend() has waited for the next budget period
+ *
+ * @param *pTxBuff = staging buffer from prepareToSend()
+ * @param *pToken = completion token, NULL if not required
+ * @retval see @ref HmiQueueBuffer() function for return value
+ */
+Ret_Status_t HmiQueueBufferWait(Nextion_TxBuffer_t *pTxBuff, Nextion_Token_t *pToken) {
+	return queueBuffer(pTxBuff, pToken, 1);
 }
 
 /**
- * @brief Identification of raw data in an incoming stream
- * @note  RAW data sent in 4 byte 32-bit little endian order
- * TODO: improvement required!
- * @param void
- * @retval 1 - RAW data identified, not a RAW data
+ * @brief Terminate an encoded command, send it and wait for its answer
+ * @note  The command is pipelined with the other commands, its answer is matched
+ * 		  by the expectation list. Completes latest NEX_ANSW_TIMEOUT after the transmission.
+ *
+ * @param *pTxBuff = staging buffer from prepareToSend(0)
+ * @param expect = expected answer of the command
+ * @param *pRetCommand = returned data, NULL if not required
+ * @retval 	STAT_TIMEOUT	= no answer received
+ * 			STAT_FAILED		= command execution failed
+ * 			STAT_ERROR		= command could not be transmitted, or it was truncated by the encoder
+ * 			STAT_BUSY		= the task is over its wire-time budget (ADMIT_REJECT)
+ * 			STAT_OK 		= command was successfully executed
  */
-static int8_t isItRawData(void) {
-	uint32_t tempNr;
-
-	if( ( nextionHMI_h.rxCounter == 4 ) && (nextionHMI_h.xTaskToNotify == NULL) ) {
-		//Likely to be raw data
-		tempNr = *(uint32_t*)&nextionHMI_h.rxBuff[nextionHMI_h.rxPosition];
-		tempNr = tempNr & 0xFFFFFF00;
-		if(tempNr != 0xFFFFFF00){
-			//Raw data
-			return 1;
-		} else {
-			//Command or Raw data value is higher or equal than 16 777 215 (0xFFFFFF)
-			//TODO: For now let's assume, the returned data is not a raw data
-			return 0;
-		}
+Ret_Status_t HmiSendAndWait(Nextion_TxBuffer_t *pTxBuff, Nx_Expect_t expect, Ret_Command_t *pRetCommand) {
+	Nextion_Token_t token;
 
-	}
-	return 0;
+	NxHmi_TokenInit(&token, NULL, NULL);
+	token.pResult = pRetCommand;
+	pTxBuff->expect = expect;
+	HmiQueueBufferWait(pTxBuff, &token);
+
+	return NxHmi_TokenWait(&token, portMAX_DELAY);
 }
 
 /**
  * @brief Prepare to send a command
- * @note  Wait for semaphore and for the interface to be in IDLE mode
+ * @note  Wait for the interface to be ready, for the budget period of the task (see admitWait()),
+ * 		  then for a free TX staging buffer.
+ * 		  Format the command with the encode functions, then send it with HmiSendBuffer().
  *
  * @param intInit - 0 - check the interface status as well, 1 - skip checking (during reset procedure)
- * @retval void
+ * @retval staging buffer
  */
-void prepareToSend(uint8_t intInit) {
+Nextion_TxBuffer_t *prepareToSend(uint8_t intInit) {
 	if(!intInit) {
 		//the display is started but not reseted yet
 		while(nextionHMI_h.hmiStatus == COMP_INVALID) {
 			vTaskDelay(pdMS_TO_TICKS(5));
 		}
+		//Over budget wait here, not while holding the TX buffers
+		admitWait(txEngineLane());
 	}
 
-	//Wait for the semaphore to get access to the UART
-	xSemaphoreTake(nextionHMI_h.hmiUartTxSem, portMAX_DELAY);
+	return encodeBegin(txEngineLane(), portMAX_DELAY);
+}
 
-    /* At this point xTaskToNotify should be NULL as no transmission
-    is in progress. */
-	configASSERT( nextionHMI_h.xTaskToNotify == NULL );
+/**
+ * @brief Prepare to queue an async command
+ * @note  Same as prepareToSend(), but doesn't wait for the display reset,
+ * 		  and waits max. NEX_ASYNC_QUEUE_TIMEOUT for a free TX staging buffer.
+ * 		  If no buffer is free, *ppTxBuff is NULL, HmiQueueBuffer() reports the timeout.
+ * 		  If the display is not ready, the token is completed with STAT_ERROR.
+ *
+ * @param **ppTxBuff = returned staging buffer
+ * @param *pToken = completion token of the command, NULL if not required
+ * @retval 	STAT_ERROR 		= display is not ready (not reseted yet)
+ * 			STAT_OK 		= format the command, then queue it with HmiQueueBuffer()
+ */
+Ret_Status_t prepareToQueue(Nextion_TxBuffer_t **ppTxBuff, Nextion_Token_t *pToken) {
+	*ppTxBuff = NULL;
+
+	if(nextionHMI_h.hmiStatus == COMP_INVALID) {
+		if(pToken != NULL) {
+			//Nobody waits for it yet
+			pToken->xTaskWaiting = NULL;
+			tokenComplete(pToken, STAT_ERROR);
+		}
+		return STAT_ERROR;
+	}
+
+	*ppTxBuff = encodeBegin(txEngineLane(), NEX_ASYNC_QUEUE_TIMEOUT);
+	return STAT_OK;
+}
+
+/**
+ * @brief Queue a terminated command, common part of HmiQueueBuffer() and HmiQueueBufferWait()
+ * @note  Static function, intended for internal task
+ *
+ * @param *pTxBuff = staging buffer, NULL if no buffer was available
+ * @param *pToken = completion token, NULL if not required
+ * @param mayWait = 1 - blocking call, admitted over budget, 0 - drop the command over budget
+ * @retval see @ref HmiQueueBuffer() function for return value
+ */
+static Ret_Status_t queueBuffer(Nextion_TxBuffer_t *pTxBuff, Nextion_Token_t *pToken, uint8_t mayWait) {
 
-    /* Store the handle of the calling task. */
-    nextionHMI_h.xTaskToNotify = xTaskGetCurrentTaskHandle();
+	if(pToken != NULL) {
+		pToken->status = STAT_OK;
+		pToken->xTaskWaiting = NULL;
+		pToken->state = TOKEN_PENDING;
+	}
+
+	if(pTxBuff == NULL) {
+		if(pToken != NULL) {
+			tokenComplete(pToken, STAT_TIMEOUT);
+		}
+		return STAT_TIMEOUT;
+	}
 
+	encodeEnd(pTxBuff);
+	if(pTxBuff->overflow) {
+		//Truncated by the encoder (e.g. t0.txt="abc without the closing quote), never send it
+		nextionHMI_h.truncatedCnt++;
+		shadowSettle(pTxBuff->pShadowObject, pTxBuff->shadowProp, STAT_ERROR);
+		encodeDiscard(pTxBuff);
+		if(pToken != NULL) {
+			tokenComplete(pToken, STAT_ERROR);
+		}
+		return STAT_ERROR;
+	}
+	if(admitCommand(pTxBuff, mayWait) != STAT_OK) {
+		shadowSettle(pTxBuff->pShadowObject, pTxBuff->shadowProp, STAT_BUSY);
+		encodeDiscard(pTxBuff);
+		if(pToken != NULL) {
+			tokenComplete(pToken, STAT_BUSY);
+		}
+		return STAT_BUSY;
+	}
+	pTxBuff->pToken = pToken;
+	txEngineSubmit(pTxBuff);
+	return STAT_OK;
 }
 
@@ -0,0 +1,289 @@
+/*
+ * Nextion_HMI_Admit.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: György Kovács
+ *
+ *      Admission controller, wire and processing time budgets of the producer tasks
+ */
+
+#include "Nextion_HMI.h"
+
+//PRIVATE FUNCTION PROTOTYPES//
+static Nextion_Admit_t *admitSlot(TaskHandle_t xTask);
+static Nextion_Admit_t *admitCurrent(Nx_Tx_Lane_t lane);
+static void admitRollPeriod(Nextion_Admit_t *pAdmit);
+
+/**
+ * @brief Clear the budgets of the producer tasks
+ * @note  Called from NxHmi_Init()
+ *
+ * @param void
+ * @retval void
+ */
+void admitInit(void) {
+	memset(nextionHMI_h.admit, 0x00, sizeof(nextionHMI_h.admit));
+}
+
+/**
+ * @brief Predicted time of a command
+ * @note  Wire time at the current baud rate, 10 bits per character,
+ * 		  plus the learned processing time of its class
+ *
+ * @param length = encoded length, with the terminator
+ * @param paceClass = class of the command
+ * @retval time in microseconds
+ */
+uint32_t admitCost(uint16_t length, Nx_Pace_Class_t paceClass) {
+	uint32_t wireTime = ( (uint32_t)length * 10000000U ) / nextionHMI_h.pUart->Init.BaudRate;
+	uint32_t processTime = ( paceEstimate(paceClass) * (1000000U / configTICK_RATE_HZ) ) >> NEX_PACE_FRAC_BITS;
+
+	return wireTime + processTime;
+}
+
+/**
+ * @brief Wait for the next period if the budget of the calling task has run out
+ * @note  Called by the blocking commands before they take a TX buffer, so no buffer is held
+ * 		  while waiting. Only with ADMIT_DEFER and ADMIT_COALESCE, the interactive lane is not limited.
+ *
+ * @param lane = lane of the command
+ * @retval void
+ */
+void admitWait(Nx_Tx_Lane_t lane) {
+	Nextion_Admit_t *pAdmit = admitCurrent(lane);
+	TickType_t xElapsed;
+
+	if( (pAdmit == NULL) || (pAdmit->policy == ADMIT_REJECT) ) {
+		return;
+	}
+
+	admitRollPeriod(pAdmit);
+	if(pAdmit->used >= pAdmit->budget) {
+		pAdmit->deferCnt++;
+	}
+	while(pAdmit->used >= pAdmit->budget) {
+		xElapsed = xTaskGetTickCount() - pAdmit->xPeriodStart;
+		if(xElapsed < pdMS_TO_TICKS(NEX_ADMIT_PERIOD)) {
+			vTaskDelay(pdMS_TO_TICKS(NEX_ADMIT_PERIOD) - xElapsed);
+		}
+		admitRollPeriod(pAdmit);
+	}//end while loop
+}
+
+/**
+ * @brief Charge a command to the budget of the calling task
+ * @note  Called by HmiQueueBuffer(). The interactive lane is not limited.
+ * 		  The first command of a period is always admitted, even if it's longer than the budget.
+ * 		  Over budget ADMIT_DEFER and ADMIT_COALESCE admit the command of a blocking call,
+ * 		  admitWait() has waited before the command was formatted. The overrun is charged
+ * 		  to the next period.
+ *
+ * @param *pTxBuff = terminated command
+ * @param mayWait = 1 - blocking call, 0 - async call
+ * @retval 	STAT_OK 	= command can be queued
+ * 			STAT_BUSY 	= over budget with ADMIT_REJECT or in an async call, drop the command
+ */
+Ret_Status_t admitCommand(Nextion_TxBuffer_t *pTxBuff, uint8_t mayWait) {
+	Nextion_TxBuffer_t *pPart;
+	uint16_t length = 0;
+	uint32_t cost;
+
+	for(pPart = pTxBuff; pPart != NULL; pPart = pPart->pNext) {
+		length += pPart->length;
+	}//end for loop
+	cost = admitCost(length, pTxBuff->paceClass);
+	//Processing time of the further commands of a display list
+	cost += admitCost(0, pTxBuff->paceClass) * (pTxBuff->cmdCount - 1U);
+
+	return admitCharge(pTxBuff->lane, cost, mayWait);
+}
+
+/**
+ * @brief Charge a predicted time to the budget of the calling task
+ * @note  Common part of admitCommand() and the commands which bypass the staging buffers,
+ * 		  e.g. a streamed long text
+ *
+ * @param lane = lane of the command
+ * @param cost = predicted time, see admitCost()
+ * @param mayWait = 1 - blocking call, admitWait() has been called, 0 - async call
+ * @retval 	STAT_OK 	= command can be sent
+ * 			STAT_BUSY 	= over budget with ADMIT_REJECT or in an async call, drop the command
+ */
+Ret_Status_t admitCharge(Nx_Tx_Lane_t lane, uint32_t cost, uint8_t mayWait) {
+	Nextion_Admit_t *pAdmit = admitCurrent(lane);
+
+	if(pAdmit == NULL) {
+		return STAT_OK;
+	}
+
+	admitRollPeriod(pAdmit);
+	if( (pAdmit->used > 0) && ((pAdmit->used + cost) > pAdmit->budget) ) {
+		if( (pAdmit->policy == ADMIT_REJECT) || (!mayWait) ) {
+			//The async calls don't wait
+			pAdmit->rejectCnt++;
+			return STAT_BUSY;
+		}
+	}
+
+	pAdmit->used += cost;
+	pAdmit->admittedCnt++;
+	return STAT_OK;
+}
+
+/**
+ * @brief Give back the charge of a command which has not been sent
+ * @note  Counterpart of admitCharge(), in the same period
+ *
+ * @param lane = lane of the command
+ * @param cost = the charged time
+ * @retval void
+ */
+void admitRefund(Nx_Tx_Lane_t lane, uint32_t cost) {
+	Nextion_Admit_t *pAdmit = admitCurrent(lane);
+
+	if(pAdmit == NULL) {
+		return;
+	}
+	pAdmit->used = (pAdmit->used > cost) ? (pAdmit->used - cost) : 0;
+	if(pAdmit->admittedCnt > 0) {
+		pAdmit->admittedCnt--;
+	}
+}
+
+/**
+ * @brief Check if a property write of the calling task goes to the mailbox
+ * @note  Called by the numeric property setters, before formatting the command.
+ * 		  Only with ADMIT_COALESCE, when the write would be over budget.
+ *
+ * @param *pOb_handle = Nextion object handler
+ * @retval 1 - post the value to the mailbox, 0 - send the command
+ */
+uint8_t admitCoalesce(Nextion_Object_t *pOb_handle) {
+	Nextion_Admit_t *pAdmit = admitCurrent(txEngineLane());
+	uint32_t cost;
+
+	if( (pAdmit == NULL) || (pAdmit->policy != ADMIT_COALESCE) ) {
+		return 0;
+	}
+
+	//Name, ".val=", max. 11 digits and the terminator
+	cost = admitCost(encodeNameLength(pOb_handle) + 20U, PACE_SET);
+
+	admitRollPeriod(pAdmit);
+	if( (pAdmit->used > 0) && ((pAdmit->used + cost) > pAdmit->budget) ) {
+		pAdmit->coalesceCnt++;
+		return 1;
+	}
+	return 0;
+}
+
+/**
+ * @brief Set the wire-time budget of a producer task
+ * @note  Only the tasks set here are limited, the others and the touch callbacks are not.
+ * 		  The slot of the task is taken here, never by its commands.
+ *
+ * @param xTask = producer task, NULL for the calling task
+ * @param sharePercent = budget in percent of NEX_ADMIT_PERIOD, 0 - unlimited, the slot is freed
+ * @param policy = handling of the over-budget commands
+ * @retval 	STAT_FAILED = every one of the NEX_ADMIT_TASKS slots is taken
+ * 			STAT_OK 	= budget is set
+ */
+Ret_Status_t NxHmi_SetTaskBudget(TaskHandle_t xTask, uint8_t sharePercent, Nx_Admit_Policy_t policy) {
+	Nextion_Admit_t *pAdmit;
+
+	if(xTask == NULL) {
+		xTask = xTaskGetCurrentTaskHandle();
+	}
+
+	taskENTER_CRITICAL();
+	pAdmit = admitSlot(xTask);
+	if(sharePercent == 0) {
+		if(pAdmit != NULL) {
+			pAdmit->xTask = NULL;
+		}
+		taskEXIT_CRITICAL();
+		return STAT_OK;
+	}
+	if(pAdmit == NULL) {
+		pAdmit = admitSlot(NULL);
+		if(pAdmit == NULL) {
+			taskEXIT_CRITICAL();
+			return STAT_FAILED;
+		}
+		memset(pAdmit, 0x00, sizeof(Nextion_Admit_t));
+		pAdmit->xPeriodStart = xTaskGetTickCount();
+	}
+	pAdmit->budget = (uint32_t)NEX_ADMIT_PERIOD * 10U * sharePercent;
+	pAdmit->policy = policy;
+	pAdmit->xTask = xTask;
+	taskEXIT_CRITICAL();
+
+	return STAT_OK;
+}
+
+/**
+ * @brief Budgets and counters of the producer tasks
+ * @note  --
+ *
+ * @param void
+ * @retval pointer to the table of NEX_ADMIT_TASKS entries
+ */
+const Nextion_Admit_t *NxHmi_GetAdmitTable(void) {
+	return nextionHMI_h.admit;
+}
+
+//////////////////////////STATIC FUNCTIONS////////////////////////////
+
+/**
+ * @brief Budget slot of a task
+ * @note  --
+ *
+ * @param xTask = producer task, NULL for a free slot
+ * @retval slot, NULL if not found
+ */
+static Nextion_Admit_t *admitSlot(TaskHandle_t xTask) {
+
+	for(uint8_t i = 0; i < NEX_ADMIT_TASKS; i++) {
+		if(nextionHMI_h.admit[i].xTask == xTask) {
+			return &nextionHMI_h.admit[i];
+		}
+	}//end for loop
+
+	return NULL;
+}
+
+/**
+ * @brief Budget slot of the calling task
+ * @note  --
+ *
+ * @param lane = lane of the command
+ * @retval slot, NULL if the task is not limited (interactive lane or no budget set)
+ */
+static Nextion_Admit_t *admitCurrent(Nx_Tx_Lane_t lane) {
+
+	if(lane == LANE_INTERACTIVE) {
+		return NULL;
+	}
+	return admitSlot(xTaskGetCurrentTaskHandle());
+}
+
+/**
+ * @brief Start a new budget period if the current one is over
+ * @note  The overrun of the previous period is carried, if the task has been sending since
+ *
+ * @param *pAdmit = budget slot
+ * @retval void
+ */
+static void admitRollPeriod(Nextion_Admit_t *pAdmit) {
+	TickType_t xNow = xTaskGetTickCount();
+	TickType_t xElapsed = xNow - pAdmit->xPeriodStart;
+
+	if(xElapsed >= pdMS_TO_TICKS(NEX_ADMIT_PERIOD)) {
+		if( (xElapsed < pdMS_TO_TICKS(2 * NEX_ADMIT_PERIOD)) && (pAdmit->used > pAdmit->budget) ) {
+			pAdmit->used -= pAdmit->budget;
+		} else {
+			pAdmit->used = 0;
+		}
+		pAdmit->xPeriodStart = xNow;
+	}
+}
@@ -0,0 +1,331 @@
+/*
+ * Nextion_HMI_Dirty.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: György Kovács
+ *
+ *      Dirty regions, the areas drawn by the GUI commands are repainted instead of the full page
+ */
+
+#include "Nextion_HMI.h"
+
+//PRIVATE FUNCTION PROTOTYPES//
+static uint8_t dirtyOverlaps(const Nextion_Box_t *pA, const Nextion_Box_t *pB, int32_t gap);
+static void dirtyUnion(Nextion_Box_t *pDst, const Nextion_Box_t *pSrc);
+static uint32_t dirtyArea(const Nextion_Box_t *pBox);
+
+/**
+ * @brief Clear the dirty regions and the footprints
+ * @note  Called from NxHmi_Init()
+ *
+ * @param void
+ * @retval void
+ */
+void dirtyInit(void) {
+	memset(nextionHMI_h.footprints, 0x00, sizeof(nextionHMI_h.footprints));
+	nextionHMI_h.dirtyBgMode = DIRTY_BG_NONE;
+	nextionHMI_h.dirtyBgValue = 0;
+	nextionHMI_h.dirtyRepaintCnt = 0;
+	dirtyReset(0xFF);
+}
+
+/**
+ * @brief Add an area to the dirty regions
+ * @note  Clipped to the screen. Overlapping or touching regions are merged,
+ * 		  if every slot is taken, it's merged into the region which grows the least.
+ *
+ * @param *pBox = drawn area
+ * @retval void
+ */
+void dirtyMark(const Nextion_Box_t *pBox) {
+	Nextion_Box_t box = *pBox;
+	uint32_t growth, minGrowth = UINT32_MAX;
+	uint8_t best = 0;
+	uint8_t merged;
+
+	if(box.x0 < 0) box.x0 = 0;
+	if(box.y0 < 0) box.y0 = 0;
+	if(box.x1 >= NEX_SCREEN_WIDTH) box.x1 = NEX_SCREEN_WIDTH - 1;
+	if(box.y1 >= NEX_SCREEN_HEIGHT) box.y1 = NEX_SCREEN_HEIGHT - 1;
+	if( (box.x1 < box.x0) || (box.y1 < box.y0) ) {
+		return;
+	}
+
+	taskENTER_CRITICAL();
+	//A merged region may reach further regions
+	do {
+		merged = 0;
+		for(uint8_t i = 0; i < nextionHMI_h.dirtyCount; i++) {
+			if(dirtyOverlaps(&nextionHMI_h.dirtyRects[i], &box, 1)) {
+				dirtyUnion(&box, &nextionHMI_h.dirtyRects[i]);
+				nextionHMI_h.dirtyRects[i] = nextionHMI_h.dirtyRects[--nextionHMI_h.dirtyCount];
+				merged = 1;
+				break;
+			}
+		}//end for loop
+	} while(merged);
+
+	if(nextionHMI_h.dirtyCount >= NEX_DIRTY_RECTS) {
+		for(uint8_t i = 0; i < nextionHMI_h.dirtyCount; i++) {
+			Nextion_Box_t joined = nextionHMI_h.dirtyRects[i];
+			dirtyUnion(&joined, &box);
+			growth = dirtyArea(&joined) - dirtyArea(&nextionHMI_h.dirtyRects[i]);
+			if(growth < minGrowth) {
+				minGrowth = growth;
+				best = i;
+			}
+		}//end for loop
+		dirtyUnion(&nextionHMI_h.dirtyRects[best], &box);
+	} else {
+		nextionHMI_h.dirtyRects[nextionHMI_h.dirtyCount++] = box;
+	}
+	taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief Add the area of a drawing command to the dirty regions
+ * @note  Called by the GUI commands, the arguments are the first ones of the command
+ *
+ * @param prim = drawing command
+ * @param arg0..arg3 = arguments of the command, e.g. x, y, w, h of fill
+ * @retval void
+ */
+void dirtyMarkPrim(Nx_Dl_Prim_t prim, uint16_t arg0, uint16_t arg1, uint16_t arg2, uint16_t arg3) {
+	Nextion_DlItem_t item;
+	Nextion_Box_t box;
+
+	item.prim = prim;
+	item.arg[0] = arg0;
+	item.arg[1] = arg1;
+	item.arg[2] = arg2;
+	item.arg[3] = arg3;
+	dlBounds(&item, &box);
+	dirtyMark(&box);
+}
+
+/**
+ * @brief Drop the dirty regions, the page has been redrawn by the display
+ * @note  Called at page change, ref 0 and reset
+ *
+ * @param pageId = current page, 0xFF - unknown
+ * @retval void
+ */
+void dirtyReset(uint8_t pageId) {
+	taskENTER_CRITICAL();
+	nextionHMI_h.dirtyCount = 0;
+	nextionHMI_h.currentPage = pageId;
+	taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief Repaint the dirty regions with a background color
+ * @note  Use the color of the page background. Without a background
+ * 		  NxHmi_ForceRedrawComponent(NULL) refreshes the full page with ref 0.
+ *
+ * @param color = 16bit RGB color code, R-5bit G-6bit, B-5bit
+ * @retval void
+ */
+void NxHmi_DirtySetBackground(uint16_t color) {
+	nextionHMI_h.dirtyBgValue = color;
+	nextionHMI_h.dirtyBgMode = DIRTY_BG_COLOR;
+}
+
+/**
+ * @brief Repaint the dirty regions from a background picture
+ * @note  The regions are cropped from the full screen picture of the page, with xpic
+ *
+ * @param picId = Image ID from the resource
+ * @retval void
+ */
+void NxHmi_DirtySetBackgroundPic(uint8_t picId) {
+	nextionHMI_h.dirtyBgValue = picId;
+	nextionHMI_h.dirtyBgMode = DIRTY_BG_PIC;
+}
+
+/**
+ * @brief Mark an area dirty
+ * @note  For drawings which are not sent by the GUI commands of the library
+ *
+ * @param xAxis  = Upper left corner on the X axis
+ * @param yAxis  = Upper left corner on the Y axis
+ * @param width  = Width of the area
+ * @param height = Height of the area
+ * @retval void
+ */
+void NxHmi_DirtyAdd(uint16_t xAxis, uint16_t yAxis, uint16_t width, uint16_t height) {
+	dirtyMarkPrim(DL_FILL, xAxis, yAxis, width, height);
+}
+
+/**
+ * @brief Set the area of a component on its page
+ * @note  A component overlapped by a repainted region is refreshed with ref <name>
+ *
+ * @param *pOb_handle = Nextion object handler
+ * @param xAxis  = Upper left corner on the X axis
+ * @param yAxis  = Upper left corner on the Y axis
+ * @param width  = Width of the component
+ * @param height = Height of the component
+ * @retval 	STAT_FAILED = no free slot, see NEX_DIRTY_FOOTPRINTS
+ * 			STAT_OK 	= footprint is set
+ */
+Ret_Status_t NxHmi_SetFootprint(Nextion_Object_t *pOb_handle, uint16_t xAxis, uint16_t yAxis,
+									uint16_t width, uint16_t height)
+{
+	Nextion_Footprint_t *pFootprint = NULL;
+
+	for(uint8_t i = 0; i < NEX_DIRTY_FOOTPRINTS; i++) {
+		if(nextionHMI_h.footprints[i].pObject == pOb_handle) {
+			pFootprint = &nextionHMI_h.footprints[i];
+			break;
+		}
+		if( (pFootprint == NULL) && (nextionHMI_h.footprints[i].pObject == NULL) ) {
+			pFootprint = &nextionHMI_h.footprints[i];
+		}
+	}//end for loop
+
+	if(pFootprint == NULL) {
+		return STAT_FAILED;
+	}
+	pFootprint->area.x0 = xAxis;
+	pFootprint->area.y0 = yAxis;
+	pFootprint->area.x1 = (int32_t)xAxis + width - 1;
+	pFootprint->area.y1 = (int32_t)yAxis + height - 1;
+	pFootprint->pObject = pOb_handle;
+
+	return STAT_OK;
+}
+
+/**
+ * @brief Repaint only the dirty regions of the page
+ * @note  Every region is painted with the background, then the components overlapped by them
+ * 		  are refreshed. A full ref 0 takes 100+ ms on a big panel, this is a fraction of it.
+ * 		  If the page has been changed on the display meanwhile, there is nothing to repaint.
+ * 		  The regions are taken over to the stack (NEX_DIRTY_RECTS * 16 bytes), so it's reentrant.
+ *
+ * @param void
+ * @retval see @ref HmiSendAndWait() function for return value, the result of the last command
+ */
+Ret_Status_t NxHmi_DirtyRepaint(void) {
+	Nextion_Box_t rects[NEX_DIRTY_RECTS];
+	Nextion_TxBuffer_t *pTxBuff;
+	Nextion_Footprint_t *pFootprint;
+	Ret_Status_t tmpRet;
+	uint32_t refMask = 0;
+	uint8_t rectCount, cmdCount, cmd = 0;
+	uint8_t pageId;
+	uint16_t width, height;
+
+	if(nextionHMI_h.dirtyBgMode == DIRTY_BG_NONE) {
+		pTxBuff = prepareToSend(0);
+		encodeText(pTxBuff, "ref 0");
+		tmpRet = HmiSendAndWait(pTxBuff, EXPECT_ACK, NULL);
+		dirtyReset(nextionHMI_h.currentPage);
+		return tmpRet;
+	}
+	if(nextionHMI_h.dirtyCount == 0) {
+		return STAT_OK;
+	}
+
+	//A touch may have changed the page on the display, then its regions are dropped
+	tmpRet = NxHmi_GetCurrentPageId(&pageId);
+	if(tmpRet != STAT_OK) {
+		return tmpRet;
+	}
+
+	taskENTER_CRITICAL();
+	rectCount = nextionHMI_h.dirtyCount;
+	memcpy(rects, nextionHMI_h.dirtyRects, rectCount * sizeof(Nextion_Box_t));
+	nextionHMI_h.dirtyCount = 0;
+	taskEXIT_CRITICAL();
+
+	//Components overlapped by the regions
+	cmdCount = rectCount;
+	for(uint8_t i = 0; i < NEX_DIRTY_FOOTPRINTS; i++) {
+		pFootprint = &nextionHMI_h.footprints[i];
+		if( (pFootprint->pObject == NULL) || (pFootprint->pObject->Page_ID != pageId) ) {
+			continue;
+		}
+		for(uint8_t j = 0; j < rectCount; j++) {
+			if(dirtyOverlaps(&pFootprint->area, &rects[j], 0)) {
+				refMask |= (1UL << i);
+				cmdCount++;
+				break;
+			}
+		}//end for loop
+	}//end for loop
+
+	for(uint8_t i = 0; i < (rectCount + NEX_DIRTY_FOOTPRINTS); i++) {
+		if( (i >= rectCount) && !(refMask & (1UL << (i - rectCount))) ) {
+			continue;
+		}
+		pTxBuff = prepareToSend(0);
+		if(i < rectCount) {
+			width = (uint16_t)(rects[i].x1 - rects[i].x0 + 1);
+			height = (uint16_t)(rects[i].y1 - rects[i].y0 + 1);
+			if(nextionHMI_h.dirtyBgMode == DIRTY_BG_PIC) {
+				encodeCommand(pTxBuff, "xpic ", 7, rects[i].x0, rects[i].y0, width, height,
+							  rects[i].x0, rects[i].y0, nextionHMI_h.dirtyBgValue);
+			} else {
+				encodeCommand(pTxBuff, "fill ", 5, rects[i].x0, rects[i].y0, width, height,
+							  nextionHMI_h.dirtyBgValue);
+			}
+			nextionHMI_h.dirtyRepaintCnt++;
+		} else {
+			encodeText(pTxBuff, "ref ");
+			encodeText(pTxBuff, nextionHMI_h.footprints[i - rectCount].pObject->Name);
+		}
+
+		if(++cmd < cmdCount) {
+			//Pipelined, only the last one is waited
+			tmpRet = HmiQueueBufferWait(pTxBuff, NULL);
+			if(tmpRet != STAT_OK) {
+				return tmpRet;
+			}
+		} else {
+			tmpRet = HmiSendAndWait(pTxBuff, EXPECT_ACK, NULL);
+		}
+	}//end for loop
+
+	return tmpRet;
+}
+
+//////////////////////////STATIC FUNCTIONS////////////////////////////
+
+/**
+ * @brief Check if two areas overlap
+ * @note  --
+ *
+ * @param *pA, *pB = areas
+ * @param gap = touching areas count as overlapping if they are closer than this
+ * @retval 1 - overlap, 0 - separate
+ */
+static uint8_t dirtyOverlaps(const Nextion_Box_t *pA, const Nextion_Box_t *pB, int32_t gap) {
+	return (pA->x0 <= (pB->x1 + gap)) && (pB->x0 <= (pA->x1 + gap)) &&
+		   (pA->y0 <= (pB->y1 + gap)) && (pB->y0 <= (pA->y1 + gap));
+}
+
+/**
+ * @brief Extend an area to cover another one
+ * @note  --
+ *
+ * @param *pDst = area to extend
+ * @param *pSrc = area to cover
+ * @retval void
+ */
+static void dirtyUnion(Nextion_Box_t *pDst, const Nextion_Box_t *pSrc) {
+	if(pSrc->x0 < pDst->x0) pDst->x0 = pSrc->x0;
+	if(pSrc->y0 < pDst->y0) pDst->y0 = pSrc->y0;
+	if(pSrc->x1 > pDst->x1) pDst->x1 = pSrc->x1;
+	if(pSrc->y1 > pDst->y1) pDst->y1 = pSrc->y1;
+}
+
+/**
+ * @brief Size of an area
+ * @note  --
+ *
+ * @param *pBox = area
+ * @retval number of pixels
+ */
+static uint32_t dirtyArea(const Nextion_Box_t *pBox) {
+	return (uint32_t)(pBox->x1 - pBox->x0 + 1) * (uint32_t)(pBox->y1 - pBox->y0 + 1);
+}
@@ -0,0 +1,476 @@
+/*
+ * Nextion_HMI_DisplayList.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: György Kovács
+ *
+ *      Display list, drawing primitives recorded, optimized and sent in one burst
+ */
+
+#include "Nextion_HMI.h"
+#include "stdarg.h"
+
+typedef struct {
+	const char *cmd;
+	uint8_t argc;
+} Dl_Command_t;
+
+//Commands of the primitives, in Nx_Dl_Prim_t order
+static const Dl_Command_t dlCommands[DL_PRIM_COUNT] = {
+	{ "fill ", 5 }, { "draw ", 5 }, { "line ", 5 }, { "cir ", 4 },
+	{ "cirs ", 4 }, { "pic ", 3 }, { "xpic ", 7 }
+};
+
+//PRIVATE FUNCTION PROTOTYPES//
+static Ret_Status_t dlAdd(Nextion_DisplayList_t *pList, Nx_Dl_Prim_t prim, uint8_t argc, ...);
+static void dlRemove(Nextion_DisplayList_t *pList, uint8_t index);
+static uint8_t dlMergeFills(Nextion_DlItem_t *pFirst, const Nextion_DlItem_t *pSecond);
+static void dlOptimize(Nextion_DisplayList_t *pList);
+
+/**
+ * @brief Empty a display list
+ * @note  Call it before recording the first primitive
+ *
+ * @param *pList = display list
+ * @retval void
+ */
+void NxHmi_DlClear(Nextion_DisplayList_t *pList) {
+	pList->count = 0;
+	pList->overflow = 0;
+	pList->codeLength = 0;
+	pList->optimizedCnt = 0;
+}
+
+/**
+ * @brief Record a filled rectangle
+ * @note  Same as the fill command: upper left corner, width and height
+ *
+ * @param *pList = display list
+ * @param xAxis  = Upper left corner on the X axis
+ * @param yAxis  = Upper left corner on the Y axis
+ * @param width  = Width of the rectangle
+ * @param height = Height of the rectangle
+ * @param color  = The color of the rectangle
+ * @retval 	STAT_FAILED = the list is full, the primitive is dropped
+ * 			STAT_OK 	= the primitive is recorded
+ */
+Ret_Status_t NxHmi_DlFill(Nextion_DisplayList_t *pList, uint16_t xAxis, uint16_t yAxis,
+									uint16_t width, uint16_t height, uint16_t color)
+{
+	return dlAdd(pList, DL_FILL, 5, xAxis, yAxis, width, height, color);
+}
+
+/**
+ * @brief Record a hollow rectangle
+ * @note  Give the start XY and the end XY coordinates
+ *
+ * @param *pList = display list
+ * @param startX = Rectangle start point on the X axis
+ * @param startY = Rectangle start point on the Y axis
+ * @param endX   = Rectangle end point on the X axis
+ * @param endY   = Rectangle end point on the Y axis
+ * @param color  = The color of the rectangle
+ * @retval see @ref NxHmi_DlFill() function for return value
+ */
+Ret_Status_t NxHmi_DlRect(Nextion_DisplayList_t *pList, uint16_t startX, uint16_t startY,
+									uint16_t endX, uint16_t endY, uint16_t color)
+{
+	return dlAdd(pList, DL_RECT, 5, startX, startY, endX, endY, color);
+}
+
+/**
+ * @brief Record a line
+ * @note  Give the start XY and the end XY coordinates
+ *
+ * @param *pList = display list
+ * @param startX = Line start point on the X axis
+ * @param startY = Line start point on the Y axis
+ * @param endX   = Line end point on the X axis
+ * @param endY   = Line end point on the Y axis
+ * @param color  = The color of the line
+ * @retval see @ref NxHmi_DlFill() function for return value
+ */
+Ret_Status_t NxHmi_DlLine(Nextion_DisplayList_t *pList, uint16_t startX, uint16_t startY,
+									uint16_t endX, uint16_t endY, uint16_t color)
+{
+	return dlAdd(pList, DL_LINE, 5, startX, startY, endX, endY, color);
+}
+
+/**
+ * @brief Record a circle
+ * @note  Give the center XY coordinates end the radius
+ *
+ * @param *pList = display list
+ * @param centX  = Circle center point on the X axis
+ * @param centY  = Circle center point on the Y axis
+ * @param radius = Radius of the circle
+ * @param color  = The color of the circle
+ * @param fMode  = Circle draw mode, 1 - filled, 0 - hollow
+ * @retval see @ref NxHmi_DlFill() function for return value
+ */
+Ret_Status_t NxHmi_DlCircle(Nextion_DisplayList_t *pList, uint16_t centX, uint16_t centY,
+									uint16_t radius, uint16_t color, uint8_t fMode)
+{
+	return dlAdd(pList, fMode ? DL_CIRCLE_FILL : DL_CIRCLE, 4, centX, centY, radius, color);
+}
+
+/**
+ * @brief Record a resource image
+ * @note  The XY coordinates are the upper left corner of the image
+ *
+ * @param *pList = display list
+ * @param picId = Image ID from the resource
+ * @param xAxis = X axis on the display
+ * @param yAxis = Y axis on the display
+ * @retval see @ref NxHmi_DlFill() function for return value
+ */
+Ret_Status_t NxHmi_DlImage(Nextion_DisplayList_t *pList, uint8_t picId, uint16_t xAxis, uint16_t yAxis) {
+
+	return dlAdd(pList, DL_PIC, 3, xAxis, yAxis, picId);
+}
+
+/**
+ * @brief Record a cropped resource image
+ * @note  Same parameters as NxHmi_DrawCropImage()
+ *
+ * @param *pList = display list
+ * @param picId = Image ID from the resource
+ * @param xPane = X axis on the display
+ * @param yPane = Y axis on the display
+ * @param width = Width of the cropped area
+ * @param height = Height of the cropped area
+ * @param xImg = X axis of the crop on the image
+ * @param yImg = Y axis of the crop on the image
+ * @retval see @ref NxHmi_DlFill() function for return value
+ */
+Ret_Status_t NxHmi_DlCropImage(Nextion_DisplayList_t *pList, uint8_t picId, uint16_t xPane, uint16_t yPane,
+									uint16_t width, uint16_t height, uint16_t xImg, uint16_t yImg)
+{
+	return dlAdd(pList, DL_XPIC, 7, xPane, yPane, width, height, xImg, yImg, picId);
+}
+
+/**
+ * @brief Optimize the recorded primitives and compile them into commands
+ * @note  Drops the primitives out of the screen and the ones fully covered by a later fill,
+ * 		  merges the adjacent fills of the same color. The compiled list can be replayed
+ * 		  any number of times with NxHmi_DlReplay(), e.g. a static overlay.
+ *
+ * @param *pList = display list
+ * @retval 	STAT_FAILED = the commands don't fit into NEX_DL_CODE_SIZE
+ * 			STAT_OK 	= the list is compiled
+ */
+Ret_Status_t NxHmi_DlCompile(Nextion_DisplayList_t *pList) {
+	const Dl_Command_t *pCmd;
+	char digits[5];
+	uint8_t nDigits;
+	uint16_t length = 0;
+	uint16_t number;
+
+	dlOptimize(pList);
+
+	for(uint8_t i = 0; i < pList->count; i++) {
+		pCmd = &dlCommands[pList->items[i].prim];
+		//Command, 7 arguments of max. 5 digits with the commas and the terminator
+		if( (length + strlen(pCmd->cmd) + (pCmd->argc * 6) + 3) > NEX_DL_CODE_SIZE ) {
+			pList->codeLength = 0;
+			return STAT_FAILED;
+		}
+		memcpy(&pList->code[length], pCmd->cmd, strlen(pCmd->cmd));
+		length += strlen(pCmd->cmd);
+
+		for(uint8_t j = 0; j < pCmd->argc; j++) {
+			if(j > 0) {
+				pList->code[length++] = ',';
+			}
+			number = pList->items[i].arg[j];
+			nDigits = 0;
+			do {
+				digits[nDigits++] = '0' + (number % 10U);
+				number /= 10U;
+			} while(number > 0);
+			while(nDigits > 0) {
+				pList->code[length++] = digits[--nDigits];
+			}//end while loop
+		}//end for loop
+
+		memset(&pList->code[length], 0xFF, 3);
+		length += 3;
+	}//end for loop
+
+	pList->codeLength = length;
+	return STAT_OK;
+}
+
+/**
+ * @brief Compile the list if needed, then send it
+ * @note  See NxHmi_DlCompile() and NxHmi_DlReplay()
+ *
+ * @param *pList = display list
+ * @retval 	STAT_FAILED = the list can't be compiled, or a primitive failed
+ * 			other		= see @ref NxHmi_DlReplay() function for return value
+ */
+Ret_Status_t NxHmi_DlSubmit(Nextion_DisplayList_t *pList) {
+
+	if( (pList->codeLength == 0) && (pList->count > 0) ) {
+		if(NxHmi_DlCompile(pList) != STAT_OK) {
+			return STAT_FAILED;
+		}
+	}
+	return NxHmi_DlReplay(pList);
+}
+
+/**
+ * @brief Send the compiled commands of a display list
+ * @note  Instead of one round trip per primitive, the commands go in one burst.
+ * 		  A burst carries max. NEX_PIPELINE_DEPTH commands, a long list is split into more.
+ * 		  Waits for the answer of the last command. The drawn areas are marked dirty.
+ *
+ * @param *pList = compiled display list
+ * @retval 	STAT_FAILED = the list is not compiled
+ * 			STAT_ERROR 	= the commands don't fit into the TX buffers
+ * 			other		= see @ref HmiSendAndWait() function for return value, the result of the last burst
+ */
+Ret_Status_t NxHmi_DlReplay(const Nextion_DisplayList_t *pList) {
+	Nextion_TxBuffer_t *pTxBuff;
+	Nextion_Box_t box;
+	Ret_Status_t tmpRet;
+	uint16_t start = 0;
+	uint16_t end;
+	uint16_t next;
+	uint8_t cmdCount;
+
+	if(pList->codeLength == 0) {
+		return (pList->count == 0) ? STAT_OK : STAT_FAILED;
+	}
+	for(uint8_t i = 0; i < pList->count; i++) {
+		dlBounds(&pList->items[i], &box);
+		dirtyMark(&box);
+	}//end for loop
+
+	while(start < pList->codeLength) {
+		//Take whole commands while they fit into a chain of buffers
+		end = start;
+		cmdCount = 0;
+		while( (end < pList->codeLength) && (cmdCount < NEX_PIPELINE_DEPTH) ) {
+			next = end;
+			while(pList->code[next] != 0xFF) {
+				next++;
+			}//end while loop
+			next += 3;
+			if( (cmdCount > 0) && ((next - start - 3) > ((NEX_TX_BUFF_SIZE - 3) * NEX_TX_CHAIN_MAX)) ) {
+				break;
+			}
+			end = next;
+			cmdCount++;
+		}//end while loop
+
+		//The last terminator is added by the encoder
+		pTxBuff = prepareToSend(0);
+		encodeData(pTxBuff, &pList->code[start], end - start - 3);
+		pTxBuff->cmdCount = cmdCount;
+		if(pTxBuff->overflow) {
+			nextionHMI_h.truncatedCnt++;
+			encodeDiscard(pTxBuff);
+			return STAT_ERROR;
+		}
+		start = end;
+
+		if(start < pList->codeLength) {
+			tmpRet = HmiQueueBufferWait(pTxBuff, NULL);
+			if(tmpRet != STAT_OK) {
+				return tmpRet;
+			}
+		} else {
+			tmpRet = HmiSendAndWait(pTxBuff, EXPECT_ACK, NULL);
+		}
+	}//end while loop
+
+	return tmpRet;
+}
+
+/**
+ * @brief Area of the screen touched by a primitive
+ * @note  The size of a resource image is not known, it extends to infinity.
+ * 		  Used by the optimizer and the dirty regions.
+ *
+ * @param *pItem = primitive
+ * @param *pBox = returned area, empty if x1 < x0
+ * @retval void
+ */
+void dlBounds(const Nextion_DlItem_t *pItem, Nextion_Box_t *pBox) {
+	const uint16_t *pArg = pItem->arg;
+
+	switch (pItem->prim) {
+		case DL_FILL:
+		case DL_XPIC:
+			pBox->x0 = pArg[0];
+			pBox->y0 = pArg[1];
+			pBox->x1 = (int32_t)pArg[0] + pArg[2] - 1;
+			pBox->y1 = (int32_t)pArg[1] + pArg[3] - 1;
+			break;
+
+		case DL_RECT:
+		case DL_LINE:
+			pBox->x0 = (pArg[0] < pArg[2]) ? pArg[0] : pArg[2];
+			pBox->x1 = (pArg[0] < pArg[2]) ? pArg[2] : pArg[0];
+			pBox->y0 = (pArg[1] < pArg[3]) ? pArg[1] : pArg[3];
+			pBox->y1 = (pArg[1] < pArg[3]) ? pArg[3] : pArg[1];
+			break;
+
+		case DL_CIRCLE:
+		case DL_CIRCLE_FILL:
+			pBox->x0 = (int32_t)pArg[0] - pArg[2];
+			pBox->y0 = (int32_t)pArg[1] - pArg[2];
+			pBox->x1 = (int32_t)pArg[0] + pArg[2];
+			pBox->y1 = (int32_t)pArg[1] + pArg[2];
+			break;
+
+		default:
+			pBox->x0 = pArg[0];
+			pBox->y0 = pArg[1];
+			pBox->x1 = INT32_MAX;
+			pBox->y1 = INT32_MAX;
+			break;
+	} //end switch
+}
+
+//////////////////////////STATIC FUNCTIONS////////////////////////////
+
+/**
+ * @brief Record a primitive
+ * @note  The compiled commands are invalidated
+ *
+ * @param *pList = display list
+ * @param prim = type of the primitive
+ * @param argc = number of the arguments
+ * @param ... = int arguments in the order of the command
+ * @retval see @ref NxHmi_DlFill() function for return value
+ */
+static Ret_Status_t dlAdd(Nextion_DisplayList_t *pList, Nx_Dl_Prim_t prim, uint8_t argc, ...) {
+	Nextion_DlItem_t *pItem;
+	va_list args;
+
+	pList->codeLength = 0;
+	if(pList->count >= NEX_DL_ITEMS) {
+		pList->overflow = 1;
+		return STAT_FAILED;
+	}
+	pItem = &pList->items[pList->count++];
+	pItem->prim = prim;
+
+	va_start(args, argc);
+	for(uint8_t i = 0; i < argc; i++) {
+		pItem->arg[i] = (uint16_t)va_arg(args, int);
+	}//end for loop
+	va_end(args);
+
+	return STAT_OK;
+}
+
+/**
+ * @brief Remove a primitive, keep the order of the others
+ * @note  --
+ *
+ * @param *pList = display list
+ * @param index = primitive to remove
+ * @retval void
+ */
+static void dlRemove(Nextion_DisplayList_t *pList, uint8_t index) {
+	pList->count--;
+	memmove(&pList->items[index], &pList->items[index + 1],
+			(pList->count - index) * sizeof(Nextion_DlItem_t));
+	pList->optimizedCnt++;
+}
+
+/**
+ * @brief Merge two fills of the same color sharing a full edge
+ * @note  --
+ *
+ * @param *pFirst = fill, extended with the second one
+ * @param *pSecond = fill, drawn right after the first one
+ * @retval 1 - merged, 0 - not adjacent
+ */
+static uint8_t dlMergeFills(Nextion_DlItem_t *pFirst, const Nextion_DlItem_t *pSecond) {
+	uint16_t *pA = pFirst->arg;
+	const uint16_t *pB = pSecond->arg;
+
+	if( (pFirst->prim != DL_FILL) || (pSecond->prim != DL_FILL) || (pA[4] != pB[4]) ) {
+		return 0;
+	}
+	if( (pA[1] == pB[1]) && (pA[3] == pB[3]) && (((uint32_t)pA[2] + pB[2]) <= UINT16_MAX) ) {
+		//Same row, side by side
+		if( ((uint32_t)pA[0] + pA[2]) == pB[0] ) {
+			pA[2] += pB[2];
+			return 1;
+		}
+		if( ((uint32_t)pB[0] + pB[2]) == pA[0] ) {
+			pA[0] = pB[0];
+			pA[2] += pB[2];
+			return 1;
+		}
+	}
+	if( (pA[0] == pB[0]) && (pA[2] == pB[2]) && (((uint32_t)pA[3] + pB[3]) <= UINT16_MAX) ) {
+		//Same column, one above the other
+		if( ((uint32_t)pA[1] + pA[3]) == pB[1] ) {
+			pA[3] += pB[3];
+			return 1;
+		}
+		if( ((uint32_t)pB[1] + pB[3]) == pA[1] ) {
+			pA[1] = pB[1];
+			pA[3] += pB[3];
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/**
+ * @brief Remove the primitives which don't change the result
+ * @note  The drawing order is kept, only consecutive fills are merged
+ *
+ * @param *pList = display list
+ * @retval void
+ */
+static void dlOptimize(Nextion_DisplayList_t *pList) {
+	Nextion_Box_t box, cover;
+	uint8_t i, j;
+
+	//Out of the screen or empty
+	for(i = 0; i < pList->count; ) {
+		dlBounds(&pList->items[i], &box);
+		if( (box.x1 < box.x0) || (box.y1 < box.y0) || (box.x0 >= NEX_SCREEN_WIDTH) ||
+			(box.y0 >= NEX_SCREEN_HEIGHT) || (box.x1 < 0) || (box.y1 < 0) ) {
+			dlRemove(pList, i);
+		} else {
+			i++;
+		}
+	}//end for loop
+
+	//Adjacent fills of the same color
+	for(i = 0; (i + 1) < pList->count; ) {
+		if(dlMergeFills(&pList->items[i], &pList->items[i + 1])) {
+			dlRemove(pList, i + 1);
+		} else {
+			i++;
+		}
+	}//end for loop
+
+	//Covered by a later fill
+	for(i = 0; i < pList->count; ) {
+		dlBounds(&pList->items[i], &box);
+		for(j = i + 1; j < pList->count; j++) {
+			if(pList->items[j].prim != DL_FILL) {
+				continue;
+			}
+			dlBounds(&pList->items[j], &cover);
+			if( (box.x0 >= cover.x0) && (box.y0 >= cover.y0) && (box.x1 <= cover.x1) && (box.y1 <= cover.y1) ) {
+				break;
+			}
+		}//end for loop
+		if(j < pList->count) {
+			dlRemove(pList, i);
+		} else {
+			i++;
+		}
+	}//end for loop
+}
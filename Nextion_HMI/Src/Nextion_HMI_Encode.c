@@ -0,0 +1,509 @@
+/*
+ * Nextion_HMI_Encode.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: György Kovács
+ *
+ *      printf-free command encoder, formats straight into the TX staging buffers
+ */
+
+#include "Nextion_HMI.h"
+#include "stdarg.h"
+
+//Property part of the "<name>.<property>=" prefixes, in Nx_Shadow_Prop_t order
+static const char * const propSuffix[SHADOW_PROP_COUNT] = {
+		".val=",
+		".txt=\"",
+		".bco=",
+		".pco=",
+		","
+};
+
+static const uint8_t propSuffixLength[SHADOW_PROP_COUNT] = { 5, 6, 5, 5, 1 };
+
+//Scale of the fixed-point numbers, index is the number of decimals
+static const uint32_t decimalScale[NEX_FLOAT_MAX_DECIMALS + 1] = { 1, 10, 100, 1000, 10000, 100000, 1000000 };
+
+//PRIVATE FUNCTION PROTOTYPES//
+static void encodeBytes(Nextion_TxBuffer_t *pTxBuff, const char *pData, uint16_t length);
+static Nextion_TxBuffer_t *encodeExtend(Nextion_TxBuffer_t *pTxBuff, Nextion_TxBuffer_t *pTail);
+static Nextion_TxBuffer_t *encodeTake(Nx_Tx_Lane_t lane, TickType_t xTicksToWait);
+static char *uintToText(char *pEnd, uint32_t number);
+
+/**
+ * @brief Take a free TX staging buffer for a new command
+ * @note  Every command is formatted in its own buffer, so the tasks don't wait for each other.
+ * 		  A long command is continued in further buffers of the pool, up to NEX_TX_CHAIN_MAX.
+ * 		  The last NEX_TX_LANE_RESERVE buffers are given only to the interactive lane.
+ * 		  The encode functions accept NULL and do nothing, HmiQueueBuffer() reports it.
+ *
+ * @param lane = scheduling class of the command
+ * @param xTicksToWait = max. time to wait for a free TX buffer
+ * @retval empty staging buffer, NULL if no buffer is available
+ */
+Nextion_TxBuffer_t *encodeBegin(Nx_Tx_Lane_t lane, TickType_t xTicksToWait) {
+	Nextion_TxBuffer_t *pTxBuff = encodeTake(lane, xTicksToWait);
+
+	if(pTxBuff == NULL) {
+		return NULL;
+	}
+
+	encodeLocal(pTxBuff);
+	pTxBuff->maxParts = NEX_TX_CHAIN_MAX;
+	pTxBuff->xTicksToWait = xTicksToWait;
+	pTxBuff->lane = lane;
+
+	return pTxBuff;
+}
+
+/**
+ * @brief Prepare a buffer which is not part of the pool
+ * @note  The command must fit into the buffer, it can't be continued
+ *
+ * @param *pTxBuff = buffer, e.g. a local variable
+ * @retval void
+ */
+void encodeLocal(Nextion_TxBuffer_t *pTxBuff) {
+	pTxBuff->length = 0;
+	pTxBuff->overflow = 0;
+	pTxBuff->parts = 1;
+	pTxBuff->maxParts = 1;
+	pTxBuff->xTicksToWait = 0;
+	pTxBuff->pNext = NULL;
+	pTxBuff->xTaskToNotify = NULL;
+	pTxBuff->pToken = NULL;
+	pTxBuff->expect = EXPECT_ACK;
+	pTxBuff->paceClass = PACE_SET;
+	pTxBuff->lane = LANE_BULK;
+	pTxBuff->cmdCount = 1;
+	pTxBuff->pShadowObject = NULL;
+}
+
+/**
+ * @brief Length of the object name
+ * @note  Cached in the object, measured again when the Name pointer has changed.
+ * 		  The text of the name must not be modified in place
+ *
+ * @param *pOb_handle = Nextion object handler
+ * @retval length of the name
+ */
+uint8_t encodeNameLength(Nextion_Object_t *pOb_handle) {
+
+	if(pOb_handle->pNameCached != pOb_handle->Name) {
+		pOb_handle->NameLength = (uint8_t)strlen(pOb_handle->Name);
+		pOb_handle->pNameCached = pOb_handle->Name;
+	}
+	return pOb_handle->NameLength;
+}
+
+/**
+ * @brief Write the "<name>.<property>=" prefix of an object
+ * @note  The name length is cached in the object. For SHADOW_VIS it writes "vis <name>,"
+ *
+ * @param *pTxBuff = staging buffer
+ * @param *pOb_handle = Nextion object handler
+ * @param prop = property of the object
+ * @retval void
+ */
+void encodeObjectProp(Nextion_TxBuffer_t *pTxBuff, Nextion_Object_t *pOb_handle, Nx_Shadow_Prop_t prop) {
+
+	if(prop == SHADOW_VIS) {
+		encodeBytes(pTxBuff, "vis ", 4);
+	}
+	encodeBytes(pTxBuff, pOb_handle->Name, encodeNameLength(pOb_handle));
+	encodeBytes(pTxBuff, propSuffix[prop], propSuffixLength[prop]);
+}
+
+/**
+ * @brief Write a string
+ * @note  --
+ *
+ * @param *pTxBuff = staging buffer
+ * @param *text = string pointer
+ * @retval void
+ */
+void encodeText(Nextion_TxBuffer_t *pTxBuff, const char *text) {
+	encodeBytes(pTxBuff, text, strlen(text));
+}
+
+/**
+ * @brief Write the value of a text attribute
+ * @note  Quotes and backslashes are escaped, the string doesn't need a terminating zero
+ *
+ * @param *pTxBuff = staging buffer
+ * @param *text = string pointer
+ * @param length = number of characters
+ * @retval void
+ */
+void encodeTextEscaped(Nextion_TxBuffer_t *pTxBuff, const char *text, uint16_t length) {
+	const char *pRun = text;
+
+	for(uint16_t i = 0; i < length; i++) {
+		if( (text[i] == '"') || (text[i] == '\\') ) {
+			//The run before it, the escape, the character starts the next run
+			encodeBytes(pTxBuff, pRun, &text[i] - pRun);
+			encodeChar(pTxBuff, '\\');
+			pRun = &text[i];
+		}
+	}//end for loop
+	encodeBytes(pTxBuff, pRun, &text[length] - pRun);
+}
+
+/**
+ * @brief Write one character
+ * @note  --
+ *
+ * @param *pTxBuff = staging buffer
+ * @param c = character
+ * @retval void
+ */
+void encodeChar(Nextion_TxBuffer_t *pTxBuff, char c) {
+	encodeBytes(pTxBuff, &c, 1);
+}
+
+/**
+ * @brief Write a signed decimal number
+ * @note  --
+ *
+ * @param *pTxBuff = staging buffer
+ * @param number = integer
+ * @retval void
+ */
+void encodeInt(Nextion_TxBuffer_t *pTxBuff, int32_t number) {
+	char digits[11]; //sign and 10 digits
+	char *pStart = uintToText(&digits[sizeof(digits)], (number < 0) ? (0U - (uint32_t)number) : (uint32_t)number);
+
+	if(number < 0) {
+		*--pStart = '-';
+	}
+
+	encodeBytes(pTxBuff, pStart, &digits[sizeof(digits)] - pStart);
+}
+
+/**
+ * @brief Write a command with comma separated numeric arguments
+ * @note  e.g. encodeCommand(pTxBuff, "line ", 5, x1, y1, x2, y2, color) -> "line x1,y1,x2,y2,color"
+ *
+ * @param *pTxBuff = staging buffer
+ * @param *cmd = command with the separator, e.g. "fill " or "dim="
+ * @param argc = number of the arguments
+ * @param ... = int arguments
+ * @retval void
+ */
+void encodeCommand(Nextion_TxBuffer_t *pTxBuff, const char *cmd, uint8_t argc, ...) {
+	va_list args;
+
+	encodeText(pTxBuff, cmd);
+
+	va_start(args, argc);
+	for(uint8_t i = 0; i < argc; i++) {
+		if(i > 0) {
+			encodeChar(pTxBuff, ',');
+		}
+		encodeInt(pTxBuff, va_arg(args, int));
+	}//end for loop
+	va_end(args);
+}
+
+/**
+ * @brief Format an unsigned number as decimal text, without printf
+ * @note  --
+ *
+ * @param *pDst = destination, min. 11 bytes
+ * @param number = unsigned number
+ * @retval length of the text, without the terminating zero
+ */
+uint8_t formatUint(char *pDst, uint32_t number) {
+	char text[11];
+	char *pEnd = &text[sizeof(text) - 1];
+	char *pStart;
+
+	*pEnd = '\0';
+	pStart = uintToText(pEnd, number);
+	memcpy(pDst, pStart, pEnd - pStart + 1);
+	return (uint8_t)(pEnd - pStart);
+}
+
+/**
+ * @brief Format a float number as fixed-point text, without printf
+ * @note  Rounded to the given decimals. The integer part saturates at 4294967295,
+ * 		  NaN is formatted as "nan".
+ *
+ * @param *pDst = destination, min. NEX_FLOAT_TEXT_SIZE bytes
+ * @param number = float number
+ * @param decimals = number of decimals, max. NEX_FLOAT_MAX_DECIMALS
+ * @retval length of the text, without the terminating zero
+ */
+uint8_t formatFixed(char *pDst, float number, uint8_t decimals) {
+	char text[NEX_FLOAT_TEXT_SIZE];
+	char *pEnd = &text[NEX_FLOAT_TEXT_SIZE - 1];
+	char *pStart;
+	uint8_t negative = (number < 0.0f);
+	uint32_t intPart, fracPart;
+	float magnitude = negative ? -number : number;
+
+	if(number != number) {
+		//NaN
+		memcpy(pDst, "nan", 4);
+		return 3;
+	}
+
+	if(decimals > NEX_FLOAT_MAX_DECIMALS) {
+		decimals = NEX_FLOAT_MAX_DECIMALS;
+	}
+
+	if(magnitude >= 4294967295.0f) {
+		intPart = 0xFFFFFFFFU;
+		fracPart = 0;
+	} else {
+		intPart = (uint32_t)magnitude;
+		fracPart = (uint32_t)((magnitude - (float)intPart) * (float)decimalScale[decimals] + 0.5f);
+		if(fracPart >= decimalScale[decimals]) {
+			//Rounding carried into the integer part, e.g. 1.999 -> 2.00
+			fracPart -= decimalScale[decimals];
+			if(intPart < 0xFFFFFFFFU) {
+				intPart++;
+			}
+		}
+	}
+
+	if( (intPart == 0) && (fracPart == 0) ) {
+		//Rounded to zero, no "-0.00"
+		negative = 0;
+	}
+
+	*pEnd = '\0';
+	pStart = pEnd;
+	if(decimals > 0) {
+		//Fraction digits with leading zeros
+		for(uint8_t i = 0; i < decimals; i++) {
+			*--pStart = '0' + (fracPart % 10U);
+			fracPart /= 10U;
+		}//end for loop
+		*--pStart = '.';
+	}
+	pStart = uintToText(pStart, intPart);
+
+	if(negative) {
+		*--pStart = '-';
+	}
+
+	memcpy(pDst, pStart, pEnd - pStart + 1);
+	return (uint8_t)(pEnd - pStart);
+}
+
+/**
+ * @brief Scale a float number to the integer value of an Xfloat component
+ * @note  Rounded, saturates at the int32_t range
+ *
+ * @param number = float number
+ * @param decimals = number of decimals (vvs1 of the component), max. NEX_FLOAT_MAX_DECIMALS
+ * @retval scaled value, e.g. 12.345 with 2 decimals -> 1235
+ */
+int32_t scaleFixed(float number, uint8_t decimals) {
+	float scaled;
+
+	if(decimals > NEX_FLOAT_MAX_DECIMALS) {
+		decimals = NEX_FLOAT_MAX_DECIMALS;
+	}
+	scaled = number * (float)decimalScale[decimals];
+
+	if(scaled != scaled) {
+		//NaN
+		return 0;
+	} else if(scaled >= 2147483647.0f) {
+		return INT32_MAX;
+	} else if(scaled <= -2147483648.0f) {
+		return INT32_MIN;
+	}
+	return (int32_t)( (scaled < 0.0f) ? (scaled - 0.5f) : (scaled + 0.5f) );
+}
+
+/**
+ * @brief Attach the terminating characters
+ * @note  A truncated command is counted as an error, HmiQueueBuffer() drops it,
+ * 		  see NxHmi_GetTruncatedCount()
+ *
+ * @param *pTxBuff = staging buffer
+ * @retval void
+ */
+void encodeEnd(Nextion_TxBuffer_t *pTxBuff) {
+
+	if(pTxBuff == NULL) {
+		return;
+	}
+	if(pTxBuff->overflow) {
+		nextionHMI_h.errorCnt++;
+	}
+	pTxBuff->paceClass = paceClassify(pTxBuff->data, pTxBuff->length);
+	//Room for the terminator is kept in every part
+	while(pTxBuff->pNext != NULL) {
+		pTxBuff = pTxBuff->pNext;
+	}
+	memset(&pTxBuff->data[pTxBuff->length], 0xFF, 3);
+	pTxBuff->length += 3;
+}
+
+/**
+ * @brief Number of commands which didn't fit into the chained buffers
+ * @note  They are dropped, never sent. The token of the command gets STAT_ERROR
+ *
+ * @param void
+ * @retval Number of truncated commands since NxHmi_Init()
+ */
+uint32_t NxHmi_GetTruncatedCount(void) {
+	return nextionHMI_h.truncatedCnt;
+}
+
+/**
+ * @brief Give back the buffers of a command which is not sent
+ * @note  --
+ *
+ * @param *pTxBuff = first buffer of the command, can be NULL
+ * @retval void
+ */
+void encodeDiscard(Nextion_TxBuffer_t *pTxBuff) {
+	Nextion_TxBuffer_t *pNext;
+
+	while(pTxBuff != NULL) {
+		pNext = pTxBuff->pNext;
+		pTxBuff->pNext = NULL;
+		xQueueSend(nextionHMI_h.txFreeQHandle, &pTxBuff, 0);
+		pTxBuff = pNext;
+	}//end while loop
+}
+
+/**
+ * @brief Append preformatted data to the command
+ * @note  e.g. the compiled commands of a display list, continued in further buffers if needed
+ *
+ * @param *pTxBuff = staging buffer
+ * @param *pData = data to copy
+ * @param length = number of bytes
+ * @retval void
+ */
+void encodeData(Nextion_TxBuffer_t *pTxBuff, const uint8_t *pData, uint16_t length) {
+	encodeBytes(pTxBuff, (const char *)pData, length);
+}
+
+//////////////////////////STATIC FUNCTIONS////////////////////////////
+
+/**
+ * @brief Append data to the command, keep room for the terminating characters
+ * @note  --
+ *
+ * @param *pTxBuff = staging buffer
+ * @param *pData = data to copy
+ * @param length = number of bytes
+ * @retval void
+ */
+static void encodeBytes(Nextion_TxBuffer_t *pTxBuff, const char *pData, uint16_t length) {
+	Nextion_TxBuffer_t *pTail = pTxBuff;
+	uint16_t space;
+
+	if(pTxBuff == NULL) {
+		return;
+	}
+	while(pTail->pNext != NULL) {
+		pTail = pTail->pNext;
+	}
+
+	while(length > 0) {
+		space = (NEX_TX_BUFF_SIZE - 3) - pTail->length;
+		if(space == 0) {
+			pTail = encodeExtend(pTxBuff, pTail);
+			if(pTail == NULL) {
+				//Command does not fit, it is truncated
+				pTxBuff->overflow = 1;
+				return;
+			}
+			continue;
+		}
+		if(space > length) {
+			space = length;
+		}
+		memcpy(&pTail->data[pTail->length], pData, space);
+		pTail->length += space;
+		pData += space;
+		length -= space;
+	}//end while loop
+}
+
+/**
+ * @brief Continue the command in a new buffer of the pool
+ * @note  The wait is limited to NEX_QUEUE_TIMEOUT, the tasks which hold parts of a chain
+ * 		  can't block each other forever. The lane reserve applies to the parts as well.
+ *
+ * @param *pTxBuff = first buffer of the command
+ * @param *pTail = last buffer of the command
+ * @retval the new last buffer, NULL if the command can't be continued
+ */
+static Nextion_TxBuffer_t *encodeExtend(Nextion_TxBuffer_t *pTxBuff, Nextion_TxBuffer_t *pTail) {
+	Nextion_TxBuffer_t *pNext;
+	TickType_t xTicksToWait = pTxBuff->xTicksToWait;
+
+	if(pTxBuff->parts >= pTxBuff->maxParts) {
+		return NULL;
+	}
+	if(xTicksToWait > NEX_QUEUE_TIMEOUT) {
+		xTicksToWait = NEX_QUEUE_TIMEOUT;
+	}
+	pNext = encodeTake(pTxBuff->lane, xTicksToWait);
+	if(pNext == NULL) {
+		return NULL;
+	}
+
+	encodeLocal(pNext);
+	pTail->pNext = pNext;
+	pTxBuff->parts++;
+
+	return pNext;
+}
+
+/**
+ * @brief Write the decimal digits of a number backwards, ending before pEnd
+ * @note  --
+ *
+ * @param *pEnd = end of the digits, min. 10 bytes room before it
+ * @param number = unsigned number
+ * @retval pointer to the first digit
+ */
+static char *uintToText(char *pEnd, uint32_t number) {
+
+	do {
+		*--pEnd = '0' + (number % 10U);
+		number /= 10U;
+	} while(number > 0);
+
+	return pEnd;
+}
+
+/**
+ * @brief Take a free buffer of the pool
+ * @note  The last NEX_TX_LANE_RESERVE buffers are given only to the interactive lane
+ *
+ * @param lane = scheduling class of the command
+ * @param xTicksToWait = max. time to wait for a free TX buffer
+ * @retval free buffer, NULL if no buffer is available
+ */
+static Nextion_TxBuffer_t *encodeTake(Nx_Tx_Lane_t lane, TickType_t xTicksToWait) {
+	Nextion_TxBuffer_t *pTxBuff;
+	TimeOut_t xTimeOut;
+
+	vTaskSetTimeOutState(&xTimeOut);
+	while(1) {
+		if(xQueueReceive(nextionHMI_h.txFreeQHandle, &pTxBuff, xTicksToWait) != pdTRUE) {
+			return NULL;
+		}
+		if( (lane == LANE_INTERACTIVE) ||
+			(uxQueueMessagesWaiting(nextionHMI_h.txFreeQHandle) >= NEX_TX_LANE_RESERVE) ) {
+			return pTxBuff;
+		}
+		//Reserved for the interactive lane, give it back and try again later
+		xQueueSendToFront(nextionHMI_h.txFreeQHandle, &pTxBuff, 0);
+		if(xTaskCheckForTimeOut(&xTimeOut, &xTicksToWait) != pdFALSE) {
+			return NULL;
+		}
+		vTaskDelay(1);
+	}//end while loop
+}
@@ -9,21 +9,32 @@
 
 #include "Nextion_HMI.h"
 
+static uint16_t rgbToColour(uint8_t red, uint8_t green, uint8_t blue);
+
 /**
  * @brief Set Nextion object background color
  * @note  16bit color code ( https://nextion.tech/instruction-set/#s5 )
  *
  * @param *pOb_handle = Nextion object handler
  * @param color = 16bit RGB color code, R-5bit G-6bit, B-5bit
- * @retval see @ref waitForAnswer() function for return value
+ * @retval see @ref HmiSendAndWait() function for return value
  */
 Ret_Status_t NxHmi_SetBcoColour(Nextion_Object_t *pOb_handle, uint16_t color) {
 
-	prepareToSend(0);
-	sprintf(txBuf, "%s.bco=%u", pOb_handle->Name, color);
-	HmiSendCommand(txBuf);
+	return setObjectProp(pOb_handle, SHADOW_BCO, color);
+}
+
+/**
+ * @brief Set Nextion object font color
+ * @note  16bit color code ( https://nextion.tech/instruction-set/#s5 )
+ *
+ * @param *pOb_handle = Nextion object handler
+ * @param color = 16bit RGB color code, R-5bit G-6bit, B-5bit
+ * @retval see @ref HmiSendAndWait() function for return value
+ */
+Ret_Status_t NxHmi_SetPcoColour(Nextion_Object_t *pOb_handle, uint16_t color) {
 
-	return waitForAnswer(NULL);
+	return setObjectProp(pOb_handle, SHADOW_PCO, color);
 }
 
 /**
@@ -34,20 +45,11 @@ Ret_Status_t NxHmi_SetBcoColour(Nextion_Object_t *pOb_handle, uint16_t color) {
  * @param red = 5 bit, MAX value 31
  * @param green = 6 bit, MAX value 63
  * @param blue = 5 bit, MAX value 31
- * @retval see @ref waitForAnswer() function for return value
+ * @retval see @ref HmiSendAndWait() function for return value
  */
 Ret_Status_t NxHmi_SetBcoColourRGB(Nextion_Object_t *pOb_handle, uint8_t red, uint8_t green, uint8_t blue){
 
-	prepareToSend(0);
-	uint16_t color = (red & 0x1F);
-	color = color << 6;
-	color += (green & 0x3F);
-	color = color << 5;
-	color += (blue & 0x1F);
-	sprintf(txBuf, "%s.bco=%u", pOb_handle->Name, color);
-	HmiSendCommand(txBuf);
-
-	return waitForAnswer(NULL);
+	return NxHmi_SetBcoColour(pOb_handle, rgbToColour(red, green, blue));
 }
 
 /**
@@ -57,15 +59,14 @@ Ret_Status_t NxHmi_SetBcoColourRGB(Nextion_Object_t *pOb_handle, uint8_t red, ui
  * @param picId = Image ID from the resource
  * @param xAxis = X axis on the display
  * @param yAxis = Y axis on the display
- * @retval see @ref waitForAnswer() function for return value
+ * @retval see @ref HmiSendAndWait() function for return value
  */
 Ret_Status_t NxHmi_DrawImage(uint8_t picId, uint16_t xAxis, uint16_t yAxis) {
 
-	prepareToSend(0);
-	sprintf(txBuf, "pic %u,%u,%i", xAxis, yAxis, picId);
-	HmiSendCommand(txBuf);
-
-	return waitForAnswer(NULL);
+	Nextion_TxBuffer_t *pTxBuff = prepareToSend(0);
+	encodeCommand(pTxBuff, "pic ", 3, xAxis, yAxis, picId);
+	dirtyMarkPrim(DL_PIC, xAxis, yAxis, 0, 0);
+	return HmiSendAndWait(pTxBuff, EXPECT_ACK, NULL);
 }
 
 /**
@@ -79,17 +80,16 @@ Ret_Status_t NxHmi_DrawImage(uint8_t picId, uint16_t xAxis, uint16_t yAxis) {
  * @param height = Y axis on the display
  * @param xImg = X axis on the image
  * @param yImg = Y axis on the image
- * @retval see @ref waitForAnswer() function for return value
+ * @retval see @ref HmiSendAndWait() function for return value
  */
 Ret_Status_t NxHmi_DrawCropImage(uint8_t picId, uint16_t xPane, uint16_t yPane,
 					uint16_t width, uint16_t height, uint16_t xImg, uint16_t yImg)
 {
 
-	prepareToSend(0);
-	sprintf(txBuf, "xpic %u,%u,%u,%u,%u,%u,%i", xPane, yPane, width, height, xImg, yImg, picId);
-	HmiSendCommand(txBuf);
-
-	return waitForAnswer(NULL);
+	Nextion_TxBuffer_t *pTxBuff = prepareToSend(0);
+	encodeCommand(pTxBuff, "xpic ", 7, xPane, yPane, width, height, xImg, yImg, picId);
+	dirtyMarkPrim(DL_XPIC, xPane, yPane, width, height);
+	return HmiSendAndWait(pTxBuff, EXPECT_ACK, NULL);
 }
 
 /**
@@ -101,15 +101,14 @@ Ret_Status_t NxHmi_DrawCropImage(uint8_t picId, uint16_t xPane, uint16_t yPane,
  * @param endX   = Line end point on the X axis
  * @param endY   = Line end point on the Y axis
  * @param color  = The color of the line
- * @retval see @ref waitForAnswer() function for return value
+ * @retval see @ref HmiSendAndWait() function for return value
  */
 Ret_Status_t NxHmi_DrawLine(uint16_t startX, uint16_t startY, uint16_t endX, uint16_t endY, uint16_t color) {
 
-	prepareToSend(0);
-	sprintf(txBuf, "line %u,%u,%u,%u,%u", startX, startY, endX, endY, color);
-	HmiSendCommand(txBuf);
-
-	return waitForAnswer(NULL);
+	Nextion_TxBuffer_t *pTxBuff = prepareToSend(0);
+	encodeCommand(pTxBuff, "line ", 5, startX, startY, endX, endY, color);
+	dirtyMarkPrim(DL_LINE, startX, startY, endX, endY);
+	return HmiSendAndWait(pTxBuff, EXPECT_ACK, NULL);
 }
 
 /**
@@ -122,22 +121,22 @@ Ret_Status_t NxHmi_DrawLine(uint16_t startX, uint16_t startY, uint16_t endX, uin
  * @param endY   = Rectangle end point on the Y axis
  * @param color  = The color of the rectangle
  * @param fMode  = Rectangle draw mode, 1 - filled, 0 - hollow
- * @retval see @ref waitForAnswer() function for return value
+ * @retval see @ref HmiSendAndWait() function for return value
  */
 Ret_Status_t NxHmi_DrawRect(uint16_t startX, uint16_t startY, uint16_t endX,
 								uint16_t endY, uint16_t color, uint8_t fMode)
 {
 
-	prepareToSend(0);
+	Nextion_TxBuffer_t *pTxBuff = prepareToSend(0);
 	if(fMode) {
-		sprintf(txBuf, "fill %u,%u,%u,%u,%u", startX, startY, endX, endY, color);
+		encodeCommand(pTxBuff, "fill ", 5, startX, startY, endX, endY, color);
+		dirtyMarkPrim(DL_FILL, startX, startY, endX, endY);
 	} else {
-		sprintf(txBuf, "draw %u,%u,%u,%u,%u", startX, startY, endX, endY, color);
+		encodeCommand(pTxBuff, "draw ", 5, startX, startY, endX, endY, color);
+		dirtyMarkPrim(DL_RECT, startX, startY, endX, endY);
 	}
 
-	HmiSendCommand(txBuf);
-
-	return waitForAnswer(NULL);
+	return HmiSendAndWait(pTxBuff, EXPECT_ACK, NULL);
 }
 
 /**
@@ -149,20 +148,225 @@ Ret_Status_t NxHmi_DrawRect(uint16_t startX, uint16_t startY, uint16_t endX,
  * @param radius = Radius of the circle
  * @param color  = The color of the circle
  * @param fMode  = Circle draw mode, 1 - filled, 0 - hollow
- * @retval see @ref waitForAnswer() function for return value
+ * @retval see @ref HmiSendAndWait() function for return value
  */
 Ret_Status_t NxHmi_DrawCircle(uint16_t centX, uint16_t centY, uint16_t radius, uint16_t color, uint8_t fMode) {
 
-	prepareToSend(0);
+	Nextion_TxBuffer_t *pTxBuff = prepareToSend(0);
 	if(fMode) {
-		sprintf(txBuf, "cirs %u,%u,%u,%u", centX, centY, radius, color);
+		encodeCommand(pTxBuff, "cirs ", 4, centX, centY, radius, color);
 	} else {
-		sprintf(txBuf, "cir %u,%u,%u,%u", centX, centY, radius, color);
+		encodeCommand(pTxBuff, "cir ", 4, centX, centY, radius, color);
 	}
-	HmiSendCommand(txBuf);
+	dirtyMarkPrim(DL_CIRCLE, centX, centY, radius, 0);
+	return HmiSendAndWait(pTxBuff, EXPECT_ACK, NULL);
+}
 
-	return waitForAnswer(NULL);
+/**
+ * @brief Set Nextion object background color, without waiting
+ * @note  Async version of NxHmi_SetBcoColour()
+ *
+ * @param *pOb_handle = Nextion object handler
+ * @param color = 16bit RGB color code, R-5bit G-6bit, B-5bit
+ * @param *pToken = completion token, NULL if not required
+ * @retval see @ref NxHmi_SetTextAsync() function for return value
+ */
+Ret_Status_t NxHmi_SetBcoColourAsync(Nextion_Object_t *pOb_handle, uint16_t color, Nextion_Token_t *pToken) {
+
+	return setObjectPropAsync(pOb_handle, SHADOW_BCO, color, pToken);
 }
 
+/**
+ * @brief Set Nextion object font color, without waiting
+ * @note  Async version of NxHmi_SetPcoColour()
+ *
+ * @param *pOb_handle = Nextion object handler
+ * @param color = 16bit RGB color code, R-5bit G-6bit, B-5bit
+ * @param *pToken = completion token, NULL if not required
+ * @retval see @ref NxHmi_SetTextAsync() function for return value
+ */
+Ret_Status_t NxHmi_SetPcoColourAsync(Nextion_Object_t *pOb_handle, uint16_t color, Nextion_Token_t *pToken) {
 
+	return setObjectPropAsync(pOb_handle, SHADOW_PCO, color, pToken);
+}
+
+/**
+ * @brief Set Nextion object background color, without waiting
+ * @note  Async version of NxHmi_SetBcoColourRGB()
+ *
+ * @param *pOb_handle = Nextion object handler
+ * @param red = 5 bit, MAX value 31
+ * @param green = 6 bit, MAX value 63
+ * @param blue = 5 bit, MAX value 31
+ * @param *pToken = completion token, NULL if not required
+ * @retval see @ref NxHmi_SetTextAsync() function for return value
+ */
+Ret_Status_t NxHmi_SetBcoColourRGBAsync(Nextion_Object_t *pOb_handle, uint8_t red, uint8_t green, uint8_t blue,
+											Nextion_Token_t *pToken)
+{
+	return NxHmi_SetBcoColourAsync(pOb_handle, rgbToColour(red, green, blue), pToken);
+}
+
+/**
+ * @brief Display a resource image at specified location, without waiting
+ * @note  Async version of NxHmi_DrawImage()
+ *
+ * @param picId = Image ID from the resource
+ * @param xAxis = X axis on the display
+ * @param yAxis = Y axis on the display
+ * @param *pToken = completion token, NULL if not required
+ * @retval see @ref NxHmi_SetTextAsync() function for return value
+ */
+Ret_Status_t NxHmi_DrawImageAsync(uint8_t picId, uint16_t xAxis, uint16_t yAxis, Nextion_Token_t *pToken) {
+
+	Nextion_TxBuffer_t *pTxBuff;
+
+	if(prepareToQueue(&pTxBuff, pToken) != STAT_OK) {
+		return STAT_ERROR;
+	}
+	encodeCommand(pTxBuff, "pic ", 3, xAxis, yAxis, picId);
+	dirtyMarkPrim(DL_PIC, xAxis, yAxis, 0, 0);
+
+	return HmiQueueBuffer(pTxBuff, pToken);
+}
+
+/**
+ * @brief Display and crop a resource image at specified location, without waiting
+ * @note  Async version of NxHmi_DrawCropImage()
+ *
+ * @param picId = Image ID from the resource
+ * @param xPane = X axis on the display
+ * @param yPane = Y axis on the display
+ * @param width = X axis on the display
+ * @param height = Y axis on the display
+ * @param xImg = X axis on the image
+ * @param yImg = Y axis on the image
+ * @param *pToken = completion token, NULL if not required
+ * @retval see @ref NxHmi_SetTextAsync() function for return value
+ */
+Ret_Status_t NxHmi_DrawCropImageAsync(uint8_t picId, uint16_t xPane, uint16_t yPane, uint16_t width,
+									uint16_t height, uint16_t xImg, uint16_t yImg, Nextion_Token_t *pToken)
+{
+
+	Nextion_TxBuffer_t *pTxBuff;
+
+	if(prepareToQueue(&pTxBuff, pToken) != STAT_OK) {
+		return STAT_ERROR;
+	}
+	encodeCommand(pTxBuff, "xpic ", 7, xPane, yPane, width, height, xImg, yImg, picId);
+	dirtyMarkPrim(DL_XPIC, xPane, yPane, width, height);
 
+	return HmiQueueBuffer(pTxBuff, pToken);
+}
+
+/**
+ * @brief Draw a line on the display, without waiting
+ * @note  Async version of NxHmi_DrawLine()
+ *
+ * @param startX = Line start point on the X axis
+ * @param startY = Line start point on the Y axis
+ * @param endX   = Line end point on the X axis
+ * @param endY   = Line end point on the Y axis
+ * @param color  = The color of the line
+ * @param *pToken = completion token, NULL if not required
+ * @retval see @ref NxHmi_SetTextAsync() function for return value
+ */
+Ret_Status_t NxHmi_DrawLineAsync(uint16_t startX, uint16_t startY, uint16_t endX, uint16_t endY,
+									uint16_t color, Nextion_Token_t *pToken)
+{
+
+	Nextion_TxBuffer_t *pTxBuff;
+
+	if(prepareToQueue(&pTxBuff, pToken) != STAT_OK) {
+		return STAT_ERROR;
+	}
+	encodeCommand(pTxBuff, "line ", 5, startX, startY, endX, endY, color);
+	dirtyMarkPrim(DL_LINE, startX, startY, endX, endY);
+
+	return HmiQueueBuffer(pTxBuff, pToken);
+}
+
+/**
+ * @brief Draw a rectangle on the display, without waiting
+ * @note  Async version of NxHmi_DrawRect()
+ *
+ * @param startX = Rectangle start point on the X axis
+ * @param startY = Rectangle start point on the Y axis
+ * @param endX   = Rectangle end point on the X axis
+ * @param endY   = Rectangle end point on the Y axis
+ * @param color  = The color of the rectangle
+ * @param fMode  = Rectangle draw mode, 1 - filled, 0 - hollow
+ * @param *pToken = completion token, NULL if not required
+ * @retval see @ref NxHmi_SetTextAsync() function for return value
+ */
+Ret_Status_t NxHmi_DrawRectAsync(uint16_t startX, uint16_t startY, uint16_t endX, uint16_t endY,
+									uint16_t color, uint8_t fMode, Nextion_Token_t *pToken)
+{
+
+	Nextion_TxBuffer_t *pTxBuff;
+
+	if(prepareToQueue(&pTxBuff, pToken) != STAT_OK) {
+		return STAT_ERROR;
+	}
+	if(fMode) {
+		encodeCommand(pTxBuff, "fill ", 5, startX, startY, endX, endY, color);
+		dirtyMarkPrim(DL_FILL, startX, startY, endX, endY);
+	} else {
+		encodeCommand(pTxBuff, "draw ", 5, startX, startY, endX, endY, color);
+		dirtyMarkPrim(DL_RECT, startX, startY, endX, endY);
+	}
+
+	return HmiQueueBuffer(pTxBuff, pToken);
+}
+
+/**
+ * @brief Draw a circle on the display, without waiting
+ * @note  Async version of NxHmi_DrawCircle()
+ *
+ * @param centX  = Circle center point on the X axis
+ * @param centY  = Circle center point on the Y axis
+ * @param radius = Radius of the circle
+ * @param color  = The color of the circle
+ * @param fMode  = Circle draw mode, 1 - filled, 0 - hollow
+ * @param *pToken = completion token, NULL if not required
+ * @retval see @ref NxHmi_SetTextAsync() function for return value
+ */
+Ret_Status_t NxHmi_DrawCircleAsync(uint16_t centX, uint16_t centY, uint16_t radius, uint16_t color,
+									uint8_t fMode, Nextion_Token_t *pToken)
+{
+
+	Nextion_TxBuffer_t *pTxBuff;
+
+	if(prepareToQueue(&pTxBuff, pToken) != STAT_OK) {
+		return STAT_ERROR;
+	}
+	if(fMode) {
+		encodeCommand(pTxBuff, "cirs ", 4, centX, centY, radius, color);
+	} else {
+		encodeCommand(pTxBuff, "cir ", 4, centX, centY, radius, color);
+	}
+	dirtyMarkPrim(DL_CIRCLE, centX, centY, radius, 0);
+
+	return HmiQueueBuffer(pTxBuff, pToken);
+}
+
+//////////////////////////STATIC FUNCTIONS////////////////////////////
+
+/**
+ * @brief Convert RGB components to 16bit color code
+ * @note  Static function
+ *
+ * @param red = 5 bit, MAX value 31
+ * @param green = 6 bit, MAX value 63
+ * @param blue = 5 bit, MAX value 31
+ * @retval 16bit RGB color code, R-5bit G-6bit, B-5bit
+ */
+static uint16_t rgbToColour(uint8_t red, uint8_t green, uint8_t blue) {
+	uint16_t color = (red & 0x1F);
+	color = color << 6;
+	color += (green & 0x3F);
+	color = color << 5;
+	color += (blue & 0x1F);
+
+	return color;
+}
@@ -11,34 +11,52 @@
 
 
 /**
- * @brief UART RX Complete Callback
- * @note  If you use other UART in interrupt mode, please implement it here
+ * @brief UART RX Event Callback
+ * @note  Called by the circular DMA reception at idle line, half and full transfer.
+ * 		  If you use other UART in reception to idle mode, please implement it here
  *
  * @param *huart = UART Handler
+ * @param Size = write position of the DMA in the RX ring, the only writer of rxHead
  * @retval void
  */
-void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart) {
+void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size) {
 
 	if(huart == nextionHMI_h.pUart) {
-		static BaseType_t xHigherPriorityTaskWoken = pdFALSE;
-		if(nextionHMI_h.rxCounter >= NEX_RX_BUFF_SIZE) {
-			//Serial RX buffer overflow TODO :
-			nextionHMI_h.rxCounter = nextionHMI_h.rxPosition = 0;
-			nextionHMI_h.errorCnt++;
-			HAL_UART_Receive_IT(nextionHMI_h.pUart, &nextionHMI_h.rxBuff[nextionHMI_h.rxCounter], 1);
-		} else {
-			HAL_UART_Receive_IT(nextionHMI_h.pUart, &nextionHMI_h.rxBuff[++nextionHMI_h.rxCounter], 1);
-		}
-		//Start/reset the timer at every received bytes
-		xTimerResetFromISR(nextionHMI_h.rxTimerHandle, &xHigherPriorityTaskWoken);
+		BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+		uint16_t dmaPos = (Size >= NEX_RX_BUFF_SIZE) ? 0 : Size;
+		//The events come at least every half ring, the DMA can't lap the last position
+		nextionHMI_h.rxHead += (uint16_t)(dmaPos - nextionHMI_h.rxDmaPos) & RX_RING_MASK;
+		nextionHMI_h.rxDmaPos = dmaPos;
+		//Half and full transfer events come in the middle of a stream
+		nextionHMI_h.rxIdle = (Size != NEX_RX_BUFF_SIZE) && (Size != (NEX_RX_BUFF_SIZE / 2));
 		//If a TX timer is started, HAL_UART_TxCpltCallback has been called
 		if(nextionHMI_h.hmiStatus == COMP_BUSY_TX){
 			//timer is active
-			xTimerResetFromISR(nextionHMI_h.blockTx, pdFALSE);
+			xTimerResetFromISR(nextionHMI_h.blockTx, &xHigherPriorityTaskWoken);
 		}
+		//Wake up the RxTask to process the received stream
+		vTaskNotifyGiveFromISR((TaskHandle_t)hmiRxTaskHandle, &xHigherPriorityTaskWoken);
 		portYIELD_FROM_ISR( xHigherPriorityTaskWoken );
 	}//end if NEX port
+}
 
+/**
+ * @brief UART Error Callback
+ * @note  The HAL stops the DMA reception at an overrun, noise or framing error,
+ * 		  the RX task restarts it. If you use other UART in interrupt mode, please implement it here
+ *
+ * @param *huart = UART Handler
+ * @retval void
+ */
+void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart) {
+
+	if(huart == nextionHMI_h.pUart) {
+		BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+		nextionHMI_h.errorCnt++;
+		nextionHMI_h.rxRestart = 1;
+		vTaskNotifyGiveFromISR((TaskHandle_t)hmiRxTaskHandle, &xHigherPriorityTaskWoken);
+		portYIELD_FROM_ISR( xHigherPriorityTaskWoken );
+	}//end if NEX port
 }
 
 /**
@@ -51,42 +69,25 @@ void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart) {
 void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart) {
 	if(huart == nextionHMI_h.pUart) {
 		//nextionHMI_h.hmiStatus = COMP_BUSY_RX;
-		static BaseType_t xHigherPriorityTaskWoken = pdFALSE;
-		// Notify the sending task
-		vTaskNotifyGiveFromISR(nextionHMI_h.xTaskToNotify, &xHigherPriorityTaskWoken);
-		// The sending task is no longer waiting
-		nextionHMI_h.xTaskToNotify = NULL;
+		BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+		// Notify the sending task and give back the TX buffer
+		txEngineCompleteFromISR(&xHigherPriorityTaskWoken);
 		//PULSE();//dbg
 		//Every received byte will reset the timer
 		if(nextionHMI_h.hmiStatus != COMP_INVALID) {
 			nextionHMI_h.hmiStatus = COMP_BUSY_TX;
 		}
-			xTimerResetFromISR(nextionHMI_h.blockTx, pdFALSE);
-		//}
+		//Wait as long as the display needs for the burst, learned from the answers
+		xTimerChangePeriodFromISR(nextionHMI_h.blockTx, paceBurstPeriod(nextionHMI_h.txBurstPace), &xHigherPriorityTaskWoken);
 
 		portYIELD_FROM_ISR( xHigherPriorityTaskWoken );
 	}//end if NEX port
 }
 
-/**
- * @brief RX Timer Callback
- * @note  Fires when RxTimer expires, RX line is IDLE
- *
- * @param *argument
- * @retval void
- */
-void rxTimerCallback(void *argument) {
-	//The RX timer has expired, no more incoming bytes on the RX line
-	xTimerStop(nextionHMI_h.rxTimerHandle,0);
-	//PULSE();
-	//Wake up the RxTask to process the received stream
-	xTaskNotify(hmiRxTaskHandle, 0, eSetValueWithOverwrite);
-}
-
 /**
  * @brief TX Timer Callback
  * @note  Fires when TxTimer expires, data is processed or simply timeout occurred
- * 		  Continue executing the next command
+ * 		  Continue executing the next command. The period is set by the pacing after every burst.
  *
  * @param *argument
  * @retval void
@@ -95,10 +96,18 @@ void txTimerCallback(void *argument) {
 	//The TX timer has expired, send the next command
 	xTimerStop(nextionHMI_h.blockTx,0);
 	//PULSE();//dbg
-	//Give back the semaphore for the next command
 	if(nextionHMI_h.hmiStatus != COMP_INVALID) {
 		nextionHMI_h.hmiStatus = COMP_IDLE;
 		//nextionHMI_h.hmiStatus = COMP_BUSY_RX;
 	}
-	xSemaphoreGive(nextionHMI_h.hmiUartTxSem);
+	if(nextionHMI_h.txHoldLine) {
+		//The display has processed the last burst, no success answer with bkcmd < 3
+		expectResolveQuiet();
+		nextionHMI_h.txHoldLine = 0;
+		if(!nextionHMI_h.txTransparent) {
+			//The line is free, start the next waiting command
+			nextionHMI_h.txLineBusy = 0;
+			txEngineKick();
+		}
+	}
 }
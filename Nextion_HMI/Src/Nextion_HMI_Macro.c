@@ -0,0 +1,181 @@
+/*
+ * Nextion_HMI_Macro.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: György Kovács
+ *
+ *      Display-side macros, command sequences run by a script of the HMI project
+ */
+
+#include "Nextion_HMI.h"
+
+//Global variables of the display, the packed parameters of a macro
+static const char * const macroArgVar[NEX_MACRO_ARGS] = {
+		"sys0=",
+		"sys1=",
+		"sys2="
+};
+
+/**
+ * @brief Clear the macro registry
+ * @note  Called from NxHmi_Init()
+ *
+ * @param void
+ * @retval void
+ */
+void macroInit(void) {
+	memset(nextionHMI_h.macros, 0x00, sizeof(nextionHMI_h.macros));
+}
+
+/**
+ * @brief Verified macro of a driver operation, usable on the current page
+ * @note  The driver functions fall back to their command sequence if it returns NULL
+ *
+ * @param op = driver operation
+ * @retval registered macro, NULL if there is none or it's not verified
+ */
+Nextion_Macro_t *macroFind(Nx_Macro_Op_t op) {
+	Nextion_Macro_t *pMacro;
+
+	for(uint8_t i = 0; i < NEX_MACRO_SLOTS; i++) {
+		pMacro = nextionHMI_h.macros[i];
+		if( (pMacro != NULL) && (pMacro->op == op) && macroReady(pMacro) ) {
+			return pMacro;
+		}
+	}//end for loop
+	return NULL;
+}
+
+/**
+ * @brief Check if a macro can be run on the current page
+ * @note  --
+ *
+ * @param *pMacro = macro handler, can be NULL
+ * @retval 1 - verified and on the last known page, 0 - use the fallback
+ */
+uint8_t macroReady(const Nextion_Macro_t *pMacro) {
+
+	if( (pMacro == NULL) || (!pMacro->verified) ) {
+		return 0;
+	}
+	return (pMacro->Page_ID == NEX_MACRO_ANY_PAGE) || (pMacro->Page_ID == nextionHMI_h.currentPage);
+}
+
+/**
+ * @brief Write the trigger command of a macro
+ * @note  click <name>,1 or <name>.en=1
+ *
+ * @param *pTxBuff = staging buffer
+ * @param *pMacro = macro handler
+ * @retval void
+ */
+void macroEncodeTrigger(Nextion_TxBuffer_t *pTxBuff, const Nextion_Macro_t *pMacro) {
+
+	if(pMacro->trigger == MACRO_TRIGGER_TIMER) {
+		encodeText(pTxBuff, pMacro->Name);
+		encodeText(pTxBuff, ".en=1");
+	} else {
+		encodeText(pTxBuff, "click ");
+		encodeText(pTxBuff, pMacro->Name);
+		encodeText(pTxBuff, ",1");
+	}
+}
+
+/**
+ * @brief Register a macro of the HMI project
+ * @note  The macro is a hotspot (touch press event) or a timer (timer event) with the script
+ * 		  of the command sequence, it reads its parameters from sys0-sys2.
+ * 		  Check it with NxHmi_MacroVerify() before use.
+ *
+ * @param *pMacro = macro handler, global variable
+ * @retval 	STAT_FAILED = every slot is taken, see NEX_MACRO_SLOTS
+ * 			STAT_OK 	= registered
+ */
+Ret_Status_t NxHmi_MacroRegister(Nextion_Macro_t *pMacro) {
+	Ret_Status_t retStatus = STAT_FAILED;
+
+	pMacro->verified = 0;
+
+	taskENTER_CRITICAL();
+	for(uint8_t i = 0; i < NEX_MACRO_SLOTS; i++) {
+		if(nextionHMI_h.macros[i] == pMacro) {
+			retStatus = STAT_OK;
+			break;
+		}
+		if( (nextionHMI_h.macros[i] == NULL) && (retStatus != STAT_OK) ) {
+			nextionHMI_h.macros[i] = pMacro;
+			retStatus = STAT_OK;
+		}
+	}//end for loop
+	taskEXIT_CRITICAL();
+
+	return retStatus;
+}
+
+/**
+ * @brief Check that the component of a macro exists on the display
+ * @note  Reads its id with "get <name>.id", the display must be on the page of the macro
+ *
+ * @param *pMacro = registered macro handler
+ * @retval 	STAT_FAILED	= the component is not found, or the display is on another page
+ * 			other		= see @ref HmiSendAndWait() function for return value
+ */
+Ret_Status_t NxHmi_MacroVerify(Nextion_Macro_t *pMacro) {
+	Ret_Command_t retCommand;
+	Nextion_TxBuffer_t *pTxBuff;
+	Ret_Status_t tmpRet;
+	uint8_t pageId;
+
+	pMacro->verified = 0;
+
+	tmpRet = NxHmi_GetCurrentPageId(&pageId);
+	if(tmpRet != STAT_OK) {
+		return tmpRet;
+	}
+	if( (pMacro->Page_ID != NEX_MACRO_ANY_PAGE) && (pMacro->Page_ID != pageId) ) {
+		return STAT_FAILED;
+	}
+
+	pTxBuff = prepareToSend(0);
+	encodeText(pTxBuff, "get ");
+	encodeText(pTxBuff, pMacro->Name);
+	encodeText(pTxBuff, ".id");
+	tmpRet = HmiSendAndWait(pTxBuff, EXPECT_NUMBER, &retCommand);
+
+	if(tmpRet == STAT_OK) {
+		pMacro->verified = 1;
+	}
+	return tmpRet;
+}
+
+/**
+ * @brief Run a macro of the HMI project
+ * @note  The packed parameters are written to sys0-sys2 and the macro is triggered,
+ * 		  in one burst, instead of a round trip per command of the sequence.
+ *
+ * @param *pMacro = registered macro handler
+ * @param argc = number of the parameters, max. NEX_MACRO_ARGS
+ * @param *pArgs = packed parameters, NULL if argc is 0
+ * @retval 	STAT_ERROR	= too many parameters
+ * 			other		= see @ref HmiSendAndWait() function for return value
+ */
+Ret_Status_t NxHmi_MacroRun(Nextion_Macro_t *pMacro, uint8_t argc, const int32_t *pArgs) {
+	Nextion_TxBuffer_t *pTxBuff;
+
+	if(argc > NEX_MACRO_ARGS) {
+		return STAT_ERROR;
+	}
+
+	pTxBuff = prepareToSend(0);
+	for(uint8_t i = 0; i < argc; i++) {
+		encodeCommand(pTxBuff, macroArgVar[i], 1, pArgs[i]);
+		encodeData(pTxBuff, (const uint8_t*)"\xFF\xFF\xFF", 3);
+	}//end for loop
+
+	macroEncodeTrigger(pTxBuff, pMacro);
+	//Every command of the burst is answered, see txEngineCollectLane()
+	pTxBuff->cmdCount = argc + 1U;
+
+	pMacro->runCnt++;
+	return HmiSendAndWait(pTxBuff, EXPECT_ACK, NULL);
+}
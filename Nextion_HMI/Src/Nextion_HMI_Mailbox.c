@@ -0,0 +1,177 @@
+/*
+ * Nextion_HMI_Mailbox.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: György Kovács
+ *
+ *      Latest-value-wins mailbox of the object properties, for high-rate producers
+ */
+
+#include "Nextion_HMI.h"
+
+/**
+ * @brief Clear the mailbox slots
+ * @note  Called from NxHmi_Init()
+ *
+ * @param void
+ * @retval void
+ */
+void mailboxInit(void) {
+	memset(nextionHMI_h.mailbox, 0x00, sizeof(nextionHMI_h.mailbox));
+	nextionHMI_h.mailboxDirtyCnt = 0;
+	nextionHMI_h.mailboxNext = 0;
+	nextionHMI_h.mailboxDropCnt = 0;
+}
+
+/**
+ * @brief Post the latest value of an object property
+ * @note  Never blocks. The value overwrites the previous one if that has not been sent yet,
+ * 		  the TX engine sends only the newest value when the line is free.
+ * 		  No answer is reported, the intermediate values are dropped.
+ *
+ * @param *pOb_handle = Nextion object handler
+ * @param prop = property of the object (SHADOW_VAL, SHADOW_BCO, SHADOW_PCO, SHADOW_VIS)
+ * @param value = new value
+ * @retval 	STAT_OK 	= value is posted
+ * 			STAT_FAILED = every slot holds an unsent value of another object, increase NEX_MAILBOX_SLOTS
+ * 			STAT_ERROR	= text property or the display is not initialized
+ */
+Ret_Status_t NxHmi_PostValue(Nextion_Object_t *pOb_handle, Nx_Shadow_Prop_t prop, int32_t value) {
+	Nextion_Mailbox_t *pSlot = NULL;
+	uint8_t wasDirty = 0;
+
+	if( (prop == SHADOW_TXT) || (prop >= SHADOW_PROP_COUNT) || (nextionHMI_h.hmiStatus == COMP_INVALID) ) {
+		return STAT_ERROR;
+	}
+
+	taskENTER_CRITICAL();
+	for(uint8_t i = 0; i < NEX_MAILBOX_SLOTS; i++) {
+		if( (nextionHMI_h.mailbox[i].pObject == pOb_handle) && (nextionHMI_h.mailbox[i].prop == prop) ) {
+			pSlot = &nextionHMI_h.mailbox[i];
+			break;
+		} else if( (pSlot == NULL) && (nextionHMI_h.mailbox[i].pObject == NULL) ) {
+			//First free slot, if the object has no slot yet
+			pSlot = &nextionHMI_h.mailbox[i];
+		}
+	}//end for loop
+
+	if(pSlot != NULL) {
+		wasDirty = pSlot->dirty;
+		if( (!wasDirty) && shadowIsCached(pOb_handle, prop, (uint32_t)value) ) {
+			//The display already shows it
+			taskEXIT_CRITICAL();
+			return STAT_OK;
+		}
+		pSlot->pObject = pOb_handle;
+		pSlot->prop = prop;
+		pSlot->value = value;
+		pSlot->seq++;
+		if(wasDirty) {
+			nextionHMI_h.mailboxDropCnt++;
+		} else {
+			pSlot->dirty = 1;
+			nextionHMI_h.mailboxDirtyCnt++;
+		}
+	}
+	taskEXIT_CRITICAL();
+
+	if(pSlot == NULL) {
+		return STAT_FAILED;
+	}
+	if(!wasDirty) {
+		txEngineWake();
+	}
+	return STAT_OK;
+}
+
+/**
+ * @brief Post the latest numeric value of a Nextion object
+ * @note  See NxHmi_PostValue()
+ *
+ * @param *pOb_handle = Nextion object handler
+ * @param number = new value
+ * @retval see NxHmi_PostValue()
+ */
+Ret_Status_t NxHmi_PostIntValue(Nextion_Object_t *pOb_handle, int16_t number) {
+	return NxHmi_PostValue(pOb_handle, SHADOW_VAL, number);
+}
+
+/**
+ * @brief Number of posted values which have been overwritten before sending
+ * @note  --
+ *
+ * @param void
+ * @retval Number of dropped values since NxHmi_Init()
+ */
+uint32_t NxHmi_GetMailboxDropCount(void) {
+	return nextionHMI_h.mailboxDropCnt;
+}
+
+/**
+ * @brief Format the next pending mailbox value into the burst
+ * @note  Called by the line holder of the TX engine. The slots are visited round robin,
+ * 		  a slot which is posted again meanwhile stays pending with the newer value,
+ * 		  otherwise it's freed.
+ *
+ * @param *pDst = burst buffer position
+ * @param space = free space in the burst buffer
+ * @param *pCmd = the formatted command, its length and shadow binding, see shadowQueue()
+ * @retval 1 - a value has been collected, 0 - nothing fits or nothing pending
+ */
+uint8_t mailboxCollect(uint8_t *pDst, uint16_t space, Nextion_TxBuffer_t *pCmd) {
+	Nextion_Mailbox_t *pSlot;
+	Nextion_Object_t *pObject;
+	Nx_Shadow_Prop_t prop;
+	int32_t value;
+	uint32_t seq;
+	uint8_t dirty;
+
+	for(uint8_t n = 0; n < NEX_MAILBOX_SLOTS; n++) {
+		if(nextionHMI_h.mailboxDirtyCnt == 0) {
+			return 0;
+		}
+
+		pSlot = &nextionHMI_h.mailbox[nextionHMI_h.mailboxNext];
+		if(++nextionHMI_h.mailboxNext >= NEX_MAILBOX_SLOTS) {
+			nextionHMI_h.mailboxNext = 0;
+		}
+
+		taskENTER_CRITICAL();
+		pObject = pSlot->pObject;
+		prop = pSlot->prop;
+		value = pSlot->value;
+		seq = pSlot->seq;
+		dirty = pSlot->dirty;
+		taskEXIT_CRITICAL();
+
+		if(!dirty) {
+			continue;
+		}
+
+		encodeLocal(pCmd);
+		encodeObjectProp(pCmd, pObject, prop);
+		encodeInt(pCmd, value);
+		encodeEnd(pCmd);
+		if(pCmd->length > space) {
+			//Keep it for the next burst, don't change the round robin order
+			nextionHMI_h.mailboxNext = (uint8_t)(pSlot - nextionHMI_h.mailbox);
+			return 0;
+		}
+
+		taskENTER_CRITICAL();
+		if(pSlot->seq == seq) {
+			//Not posted again meanwhile (even with the same value), the slot is free for any object
+			pSlot->dirty = 0;
+			pSlot->pObject = NULL;
+			nextionHMI_h.mailboxDirtyCnt--;
+		}
+		taskEXIT_CRITICAL();
+
+		memcpy(pDst, pCmd->data, pCmd->length);
+		//The cache is settled by the answer
+		shadowQueue(pCmd, pObject, prop, (uint32_t)value);
+		return 1;
+	}//end for loop
+
+	return 0;
+}
@@ -15,20 +15,21 @@
  * @note  Not mandatory, "auto-refresh when attribute changes since v0.38"
  *
  * @param *pOb_handle = Nextion object handler,
- * 			if the passed value is NULL, then refresh the complete page
- * @retval see @ref waitForAnswer() function for return value
+ * 			if the passed value is NULL, then repaint the dirty regions of the page,
+ * 			see NxHmi_DirtyRepaint(), or refresh the complete page if no background is set
+ * @retval see @ref HmiSendAndWait() function for return value
  */
 Ret_Status_t NxHmi_ForceRedrawComponent(Nextion_Object_t *pOb_handle) {
 
-	prepareToSend(0);
-	if(pOb_handle != NULL) {
-		sprintf(txBuf, "ref %s", pOb_handle->Name); //refresh just the selected component
-	} else {
-		sprintf(txBuf, "ref %i", 0);	//refresh the current page
+	if(pOb_handle == NULL) {
+		//Only the dirty regions, or ref 0 without a background
+		return NxHmi_DirtyRepaint();
 	}
-	HmiSendCommand(txBuf);
 
-	return waitForAnswer(NULL);
+	Nextion_TxBuffer_t *pTxBuff = prepareToSend(0);
+	encodeText(pTxBuff, "ref ");
+	encodeText(pTxBuff, pOb_handle->Name); //refresh just the selected component
+	return HmiSendAndWait(pTxBuff, EXPECT_ACK, NULL);
 }
 
 /**
@@ -42,11 +43,11 @@ Ret_Status_t NxHmi_ForceRedrawComponent(Nextion_Object_t *pOb_handle) {
  */
 void NxHmi_CalibrateTouchSensor(void) {
 
-	prepareToSend(0);
+	Nextion_TxBuffer_t *pTxBuff = prepareToSend(0);
 	xQueueReset(nextionHMI_h.objectQueueHandle);
 	xQueueReset(nextionHMI_h.rxCommandQHandle);
-	sprintf(txBuf, "touch_j");
-	HmiSendCommand( txBuf);
+	encodeText(pTxBuff, "touch_j");
+	HmiSendBuffer(pTxBuff);
 	if(waitForAnswer(NULL) == NEX_RET_INVALID_CMD ) {
 			//NxHmi_GetCurrentPageId();
 	} else {
@@ -75,15 +76,25 @@ void NxHmi_CalibrateTouchSensor(void) {
  *
  * @param *pOb_handle = Nextion object handler
  * @param visible = OBJ_HIDE, OBJ_SHOW
- * @retval see @ref waitForAnswer() function for return value
+ * @retval see @ref HmiSendAndWait() function for return value
  */
 Ret_Status_t NxHmi_SetObjectVisibility(Nextion_Object_t *pOb_handle, Ob_visibility_t visible) {
 
-	prepareToSend(0);
-	sprintf(txBuf, "vis %s,%d", pOb_handle->Name, visible);
-	HmiSendCommand(txBuf);
+	return setObjectProp(pOb_handle, SHADOW_VIS, visible);
+}
+
+/**
+ * @brief Set Nextion object visibility, without waiting
+ * @note  Async version of NxHmi_SetObjectVisibility()
+ *
+ * @param *pOb_handle = Nextion object handler
+ * @param visible = OBJ_HIDE, OBJ_SHOW
+ * @param *pToken = completion token, NULL if not required
+ * @retval see @ref NxHmi_SetTextAsync() function for return value
+ */
+Ret_Status_t NxHmi_SetObjectVisibilityAsync(Nextion_Object_t *pOb_handle, Ob_visibility_t visible, Nextion_Token_t *pToken) {
 
-	return waitForAnswer(NULL);
+	return setObjectPropAsync(pOb_handle, SHADOW_VIS, visible, pToken);
 }
 
 /**
@@ -91,56 +102,150 @@ Ret_Status_t NxHmi_SetObjectVisibility(Nextion_Object_t *pOb_handle, Ob_visibili
  * @note  Default page is 0
  *
  * @param pageId = Page number, 0-default
- * @retval see @ref waitForAnswer() function for return value
+ * @retval see @ref HmiSendAndWait() function for return value
  */
 Ret_Status_t NxHmi_GotoPage(uint8_t pageId) {
 
-	prepareToSend(0);
-	sprintf(txBuf, "page %i", pageId);
-	HmiSendCommand(txBuf);
+	Nextion_TxBuffer_t *pTxBuff = prepareToSend(0);
+	Ret_Status_t tmpRet;
+
+	encodeCommand(pTxBuff, "page ", 1, pageId);
+	tmpRet = HmiSendAndWait(pTxBuff, EXPECT_ACK, NULL);
+	//The components of the new page are loaded with their default values
+	NxHmi_ShadowInvalidateAll();
+	if(tmpRet == STAT_OK) {
+		dirtyReset(pageId);
+	}
 
-	return waitForAnswer(NULL);
+	return tmpRet;
 }
 
 /**
  * @brief Get a Nextion objects value
- * @note  TODO: implement string ret value
+ * @note  Numeric value, read a text with NxHmi_GetObjText()
  *
  * @param *pOb_handle = Nextion object handler
  * @param *pValue = Pointer for the returned 32bit number
- * @retval see @ref waitForAnswer() function for return value
+ * @retval 	STAT_ERROR	= not a numeric object
+ * 			other		= see @ref HmiSendAndWait() function for return value
  */
 Ret_Status_t NxHmi_GetObjValue(Nextion_Object_t *pOb_handle, uint32_t *pValue) {
 
-	prepareToSend(0);
-	xQueueReset(nextionHMI_h.rxCommandQHandle);//TODO: skip this
+	Nextion_TxBuffer_t *pTxBuff;
+	Nx_Expect_t expect = EXPECT_ACK;
 	*pValue = 0;
 	Ret_Command_t retNumber;
+	memset(&retNumber, 0x00, sizeof(Ret_Command_t));
+
+	if(pOb_handle->dataType == OBJ_TYPE_TXT) {
+		return STAT_ERROR;
+	}
 
+	pTxBuff = prepareToSend(0);
 	switch (pOb_handle->dataType) {
 		case OBJ_TYPE_INT:
-			sprintf(txBuf, "get %s.val", pOb_handle->Name);
+			encodeText(pTxBuff, "get ");
+			encodeText(pTxBuff, pOb_handle->Name);
+			encodeText(pTxBuff, ".val");
+			expect = EXPECT_NUMBER;
 			break;
 
-		case OBJ_TYPE_TXT: //TODO: not implemented yet, change "ref" to "get"
-			sprintf(txBuf, "ref %s.txt", pOb_handle->Name);
-			break;
 		default:
 			break;
 	} //end switch
-	HmiSendCommand( txBuf);
 
-	Ret_Status_t retValue = waitForAnswer(&retNumber);//TODO: ?
+	Ret_Status_t retValue = HmiSendAndWait(pTxBuff, expect, &retNumber);
 	if(retValue == STAT_OK ) {
 		*pValue = retNumber.numData;
 	}
 	return retValue;
 }
 
+/**
+ * @brief Get a Nextion objects value as raw data
+ * @note  "prints <name>.val,4", the 4 bytes are answered without head and terminator.
+ * 		  They are decoded by the expectation of the command, at any bkcmd level and for any value.
+ * 		  Limitations of the protocol:
+ * 		  - with bkcmd 2 or 3, <error code> 0xFF 0xFF 0xFF is an error answer, so a value of
+ * 		    0xFFFFFF00 or 0xFFFFFF02 - 0xFFFFFF23 is reported as STAT_FAILED,
+ * 		  - an event sent by the display (touch, page change, ...) right before the answer
+ * 		    can't be told from it, its first 4 bytes are returned as the value.
+ * 		    Disable the events or read the value when no touch is expected.
+ *
+ * @param *pOb_handle = Nextion object handler
+ * @param *pValue = Pointer for the returned 32bit number
+ * @retval 	STAT_ERROR	= not a numeric object
+ * 			STAT_FAILED	= the display has answered with an error code
+ * 			other		= see @ref HmiSendAndWait() function for return value
+ */
+Ret_Status_t NxHmi_GetObjRawValue(Nextion_Object_t *pOb_handle, uint32_t *pValue) {
+	Nextion_TxBuffer_t *pTxBuff;
+	Ret_Command_t retNumber;
+	Ret_Status_t retValue;
+
+	*pValue = 0;
+	memset(&retNumber, 0x00, sizeof(Ret_Command_t));
+
+	if(pOb_handle->dataType == OBJ_TYPE_TXT) {
+		return STAT_ERROR;
+	}
+
+	pTxBuff = prepareToSend(0);
+	encodeText(pTxBuff, "prints ");
+	encodeText(pTxBuff, pOb_handle->Name);
+	encodeText(pTxBuff, ".val,4");
+
+	retValue = HmiSendAndWait(pTxBuff, EXPECT_RAW, &retNumber);
+	if(retValue == STAT_OK) {
+		*pValue = retNumber.numData;
+	}
+	return retValue;
+}
+
+/**
+ * @brief Get the text of a Nextion object
+ * @note  "get <name>.txt", the string is received straight into a block of the string arena.
+ * 		  The text is borrowed, give it back with NxHmi_ReleaseText() when it's not needed any more.
+ * 		  A text longer than NEX_STRING_BLOCK_SIZE - 1 is truncated.
+ *
+ * @param *pOb_handle = Nextion object handler
+ * @param **ppText = returned zero terminated text, NULL if the call failed
+ * @param *pLength = length of the text, can be NULL
+ * @retval 	STAT_FAILED	= every block of the string arena is borrowed, the text is dropped
+ * 			other		= see @ref HmiSendAndWait() function for return value
+ */
+Ret_Status_t NxHmi_GetObjText(Nextion_Object_t *pOb_handle, const char **ppText, uint16_t *pLength) {
+	Nextion_TxBuffer_t *pTxBuff = prepareToSend(0);
+	Ret_Command_t retString;
+	Ret_Status_t retValue;
+
+	memset(&retString, 0x00, sizeof(Ret_Command_t));
+	*ppText = NULL;
+
+	encodeText(pTxBuff, "get ");
+	encodeText(pTxBuff, pOb_handle->Name);
+	encodeText(pTxBuff, ".txt");
+	retValue = HmiSendAndWait(pTxBuff, EXPECT_STRING, &retString);
+
+	if( (retValue == STAT_OK) && (retString.stringData == NULL) ) {
+		retValue = STAT_FAILED;
+	}
+	if(retValue == STAT_OK) {
+		*ppText = retString.stringData;
+		if(pLength != NULL) {
+			*pLength = retString.stringLength;
+		}
+	} else {
+		NxHmi_ReleaseText(retString.stringData);
+	}
+	return retValue;
+}
+
 /**
  * @brief Perform a soft reset
  * @note  Reboot the display. When it is ready, returns: 00 00 00 FF FF FF, 88 FF FF FF
- * 			takes approximately 250ms
+ * 			takes approximately 250ms. The UART goes back to the default rate of the display.
+ * 		  Then the answer level is set to NEX_BKCMD_DEFAULT, the display starts with bkcmd=2.
  *
  * @param void
  * @retval see @ref waitForAnswer() function for return value
@@ -149,26 +254,41 @@ Ret_Status_t NxHmi_ResetDevice(void) {
 	//PULSE();
 	Ret_Command_t retNumber;
 	nextionHMI_h.hmiStatus = COMP_INVALID;
+	NxHmi_ShadowInvalidateAll();
+	dirtyReset(0);
+	//The answers of the commands in flight are lost
+	expectFlush(STAT_ERROR);
+	//An addt which has got STAT_ERROR doesn't unlock the line, the 0xFD won't come
+	txEngineTransparentEnd();
 	//PULSE();
-	prepareToSend(1);
+	Nextion_TxBuffer_t *pTxBuff = prepareToSend(1);
 	nextionHMI_h.ifaceVerbose = 2;
 	xQueueReset(nextionHMI_h.rxCommandQHandle);
-	HmiSendCommand("1"); // Dummy command, send an invalid command to clear Nextions RX buffer
+	encodeText(pTxBuff, "1");
+	HmiSendBuffer(pTxBuff); // Dummy command, send an invalid command to clear Nextions RX buffer
 	waitForAnswer(NULL);
 
-	prepareToSend(1);
-	sprintf(txBuf, "rest");
-	HmiSendCommand(txBuf);
-	waitForAnswer(NULL);//drop the first answer (00 00 00 FF FF FF)
-	if(waitForAnswer(&retNumber) == STAT_FAILED){
-		//nextionHMI_h.hmiStatus = COMP_IDLE;
-		return STAT_ERROR;//TODO: the interface will stuck in INVALID mode :(
+	pTxBuff = prepareToSend(1);
+	encodeText(pTxBuff, "rest");
+	HmiSendBuffer(pTxBuff);
+	if(nextionHMI_h.pUart->Init.BaudRate != nextionHMI_h.baudDefault) {
+		//The display restarts at its default rate
+		comSpeedUart(nextionHMI_h.baudDefault);
 	}
-	if(retNumber.cmdCode == NEX_EVENT_INIT_OK) {
-		vTaskDelay(pdMS_TO_TICKS(50));
-		nextionHMI_h.hmiStatus = COMP_IDLE;
-		//PULSE();
+	//Drop the answers before the ready event: the late answer of the dummy command
+	//  at a low baud rate, and the start frame (00 00 00 FF FF FF)
+	do {
+		if(xQueueReceive(nextionHMI_h.rxCommandQHandle, &retNumber, NEX_ANSW_TIMEOUT) == pdFALSE) {
+			return STAT_ERROR;//TODO: the interface will stuck in INVALID mode :(
+		}
+	} while(retNumber.cmdCode != NEX_EVENT_INIT_OK);
+	vTaskDelay(pdMS_TO_TICKS(50));
+	nextionHMI_h.hmiStatus = COMP_IDLE;
+	if(NEX_BKCMD_DEFAULT != 2) {
+		//Every command answers at level 3, an error can't be taken for the answer of another one
+		NxHmi_Verbosity(NEX_BKCMD_DEFAULT);
 	}
+	//PULSE();
 
 	return (int8_t)retNumber.numData;
 }
@@ -178,20 +298,23 @@ Ret_Status_t NxHmi_ResetDevice(void) {
  * @note  --
  *
  * @param pValue - Pointer for the returned 8bit number (actual page ID)
- * @retval see @ref waitForAnswer() function for return value
+ * @retval see @ref HmiSendAndWait() function for return value
  */
 Ret_Status_t NxHmi_GetCurrentPageId(uint8_t *pValue) {
 
-	prepareToSend(0);
+	Nextion_TxBuffer_t *pTxBuff = prepareToSend(0);
 	Ret_Command_t tmpCommand;
 	Ret_Status_t tmpRet;
 
-	sprintf(txBuf, "sendme");
-	HmiSendCommand(txBuf);
-	tmpRet = waitForAnswer(&tmpCommand);
+	encodeText(pTxBuff, "sendme");
+	tmpRet = HmiSendAndWait(pTxBuff, EXPECT_PAGE, &tmpCommand);
 
 	if(tmpRet == STAT_OK){
 		*pValue = tmpCommand.pageId;
+		if(tmpCommand.pageId != nextionHMI_h.currentPage) {
+			//Changed on the display, the drawings of the old page are gone
+			dirtyReset(tmpCommand.pageId);
+		}
 	}
 
 	return tmpRet;
@@ -207,9 +330,12 @@ Ret_Status_t NxHmi_GetCurrentPageId(uint8_t *pValue) {
  * @retval void
  */
 void NxHmi_WaveFormAddValue(Nextion_Object_t *pOb_handle, uint8_t channel, uint8_t value) {
-	prepareToSend(0);
-	sprintf(txBuf, "add %i,%i,%i", pOb_handle->Component_ID, channel, value);
-	HmiSendCommand(txBuf);
+	Nextion_TxBuffer_t *pTxBuff = prepareToSend(0);
+	encodeCommand(pTxBuff, "add ", 3, pOb_handle->Component_ID, channel, value);
+	//Streaming, it must not delay the other commands
+	pTxBuff->lane = LANE_BACKGROUND;
+	//No answer is expected, let it coalesce with the next samples
+	HmiQueueBuffer(pTxBuff, NULL);
 }
 
 /**
@@ -218,14 +344,12 @@ void NxHmi_WaveFormAddValue(Nextion_Object_t *pOb_handle, uint8_t channel, uint8
  *
  * @param *pOb_handle = Nextion object handler
  * @param channel     = Which channel to clear
- * @retval see @ref waitForAnswer() function for return value
+ * @retval see @ref HmiSendAndWait() function for return value
  */
 Ret_Status_t NxHmi_WaveFormClearChannel(Nextion_Object_t *pOb_handle, uint8_t channel) {
 
-	prepareToSend(0);
-	sprintf(txBuf, "cle %i,%i", pOb_handle->Component_ID, channel);
-	HmiSendCommand(txBuf);
-
-	return waitForAnswer(NULL);
+	Nextion_TxBuffer_t *pTxBuff = prepareToSend(0);
+	encodeCommand(pTxBuff, "cle ", 2, pOb_handle->Component_ID, channel);
+	return HmiSendAndWait(pTxBuff, EXPECT_ACK, NULL);
 }
 
@@ -0,0 +1,183 @@
+/*
+ * Nextion_HMI_Pace.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: György Kovács
+ *
+ *      Adaptive pacing, processing time of the command classes learned from the answers
+ */
+
+#include "Nextion_HMI.h"
+
+typedef struct {
+	const char *keyword;
+	uint8_t length;
+	Nx_Pace_Class_t paceClass;
+} Pace_Keyword_t;
+
+//First word of the commands which are not simple attribute assignments
+static const Pace_Keyword_t paceKeywords[] = {
+	{ "ref", 3, PACE_REFRESH },		{ "page", 4, PACE_REFRESH },	{ "cls", 3, PACE_REFRESH },
+	{ "pic", 3, PACE_DRAW },		{ "xpic", 4, PACE_DRAW },		{ "fill", 4, PACE_DRAW },
+	{ "line", 4, PACE_DRAW },		{ "draw", 4, PACE_DRAW },		{ "cir", 3, PACE_DRAW },
+	{ "cirs", 4, PACE_DRAW },		{ "xstr", 4, PACE_DRAW },
+	{ "get", 3, PACE_QUERY },		{ "sendme", 6, PACE_QUERY },	{ "prints", 6, PACE_QUERY },
+	{ "dim", 3, PACE_SYSTEM },		{ "dims", 4, PACE_SYSTEM },		{ "bkcmd", 5, PACE_SYSTEM },
+	{ "sleep", 5, PACE_SYSTEM },	{ "thsp", 4, PACE_SYSTEM },		{ "thup", 4, PACE_SYSTEM },
+	{ "ussp", 4, PACE_SYSTEM },		{ "usup", 4, PACE_SYSTEM },		{ "sendxy", 6, PACE_SYSTEM },
+	{ "baud", 4, PACE_SYSTEM },		{ "bauds", 5, PACE_SYSTEM },	{ "touch_j", 7, PACE_SYSTEM },
+	{ "rest", 4, PACE_SYSTEM }
+};
+
+//Starting values until the first answers arrive, in milliseconds
+static const uint16_t paceDefaultTime[PACE_CLASS_COUNT] = { 1, 2, 10, 30, 5 };
+
+/**
+ * @brief Load the default processing times
+ * @note  Called from NxHmi_Init()
+ *
+ * @param void
+ * @retval void
+ */
+void paceInit(void) {
+	for(uint8_t i = 0; i < PACE_CLASS_COUNT; i++) {
+		NxHmi_SetPaceTime((Nx_Pace_Class_t)i, paceDefaultTime[i]);
+	}//end for loop
+	nextionHMI_h.paceLastAnswer = xTaskGetTickCount();
+	nextionHMI_h.txBurstPace = 0;
+}
+
+/**
+ * @brief Class of a formatted command, by its first word
+ * @note  Called by encodeEnd()
+ *
+ * @param *pData = formatted command
+ * @param length = length of the data
+ * @retval class of the command
+ */
+Nx_Pace_Class_t paceClassify(const uint8_t *pData, uint16_t length) {
+	uint8_t wordLength = 0;
+
+	while( (wordLength < length) && (wordLength < 8) &&
+		   (pData[wordLength] != ' ') && (pData[wordLength] != '=') && (pData[wordLength] != 0xFF) ) {
+		wordLength++;
+	}//end while loop
+
+	for(uint8_t i = 0; i < (sizeof(paceKeywords) / sizeof(paceKeywords[0])); i++) {
+		if( (paceKeywords[i].length == wordLength) &&
+			(memcmp(paceKeywords[i].keyword, pData, wordLength) == 0) ) {
+			return paceKeywords[i].paceClass;
+		}
+	}//end for loop
+
+	//Attribute assignment, e.g. n0.val=
+	return PACE_SET;
+}
+
+/**
+ * @brief Expected processing time of a command class
+ * @note  --
+ *
+ * @param paceClass = class of the command
+ * @retval processing time in 1/2^NEX_PACE_FRAC_BITS ticks
+ */
+uint32_t paceEstimate(Nx_Pace_Class_t paceClass) {
+	return nextionHMI_h.pace[paceClass].estimate;
+}
+
+/**
+ * @brief TX timer period after a burst
+ * @note  Wait just as long as the display needs for the commands of the burst
+ *
+ * @param burstPace = sum of the estimates of the burst, in 1/2^NEX_PACE_FRAC_BITS ticks
+ * @retval timer period in ticks
+ */
+TickType_t paceBurstPeriod(uint32_t burstPace) {
+	//Rounded up, +1 tick for the tick granularity
+	return (TickType_t)( (burstPace + (1U << NEX_PACE_FRAC_BITS) - 1U) >> NEX_PACE_FRAC_BITS ) + 1U;
+}
+
+/**
+ * @brief Time needed to put a number of bytes on the wire
+ * @note  10 bits per character
+ *
+ * @param bytes = number of bytes
+ * @retval time in ticks, rounded down
+ */
+TickType_t paceWireTicks(uint16_t bytes) {
+	return pdMS_TO_TICKS( ( (uint32_t)bytes * 10000U ) / nextionHMI_h.pUart->Init.BaudRate );
+}
+
+/**
+ * @brief Learn the processing time of a command from its answer
+ * @note  Called from the RX task. The display executes the commands one by one,
+ * 		  a command is started when it is received and the previous one is done.
+ * 		  A longer time is learned fast, a shorter one slowly, to avoid overrunning.
+ * 		  Only the successful answers at bkcmd=3 are learned, below level 3 the default
+ * 		  times or the ones of NxHmi_SetPaceTime() stay in use.
+ *
+ * @param paceClass = class of the answered command
+ * @param xTimeSent = time when the command has been received by the display
+ * @retval void
+ */
+void paceLearn(Nx_Pace_Class_t paceClass, TickType_t xTimeSent) {
+	Nextion_Pace_t *pPace = &nextionHMI_h.pace[paceClass];
+	TickType_t xNow = xTaskGetTickCount();
+	TickType_t xStart = xTimeSent;
+	int32_t sample;
+
+	if( (int32_t)(nextionHMI_h.paceLastAnswer - xStart) > 0 ) {
+		//It waited for the previous command
+		xStart = nextionHMI_h.paceLastAnswer;
+	}
+	nextionHMI_h.paceLastAnswer = xNow;
+
+	sample = (int32_t)(xNow - xStart);
+	if(sample < 0) {
+		//Answered before the end of the burst
+		sample = 0;
+	}
+	if(sample > UINT16_MAX) {
+		sample = UINT16_MAX;
+	}
+	if(sample > pPace->maxTime) {
+		pPace->maxTime = (uint16_t)sample;
+	}
+	pPace->samples++;
+
+	sample <<= NEX_PACE_FRAC_BITS;
+	if(sample > (int32_t)pPace->estimate) {
+		pPace->estimate += (uint32_t)(sample - (int32_t)pPace->estimate) >> NEX_PACE_RISE_SHIFT;
+	} else {
+		pPace->estimate -= (uint32_t)((int32_t)pPace->estimate - sample) >> NEX_PACE_FALL_SHIFT;
+	}
+}
+
+/**
+ * @brief Learned processing times of the command classes
+ * @note  Index is Nx_Pace_Class_t. Learned from the successful answers at bkcmd=3 only,
+ * 		  with other levels the times set by NxHmi_SetPaceTime() are used.
+ *
+ * @param void
+ * @retval pointer to the table of PACE_CLASS_COUNT entries
+ */
+const Nextion_Pace_t *NxHmi_GetPaceTable(void) {
+	return nextionHMI_h.pace;
+}
+
+/**
+ * @brief Set the processing time of a command class
+ * @note  Starting value of the learning, or a fixed value below bkcmd=3
+ *
+ * @param paceClass = class of the commands
+ * @param timeMs = processing time in milliseconds
+ * @retval void
+ */
+void NxHmi_SetPaceTime(Nx_Pace_Class_t paceClass, uint16_t timeMs) {
+	if(paceClass >= PACE_CLASS_COUNT) {
+		return;
+	}
+	nextionHMI_h.pace[paceClass].estimate = (uint32_t)pdMS_TO_TICKS(timeMs) << NEX_PACE_FRAC_BITS;
+	nextionHMI_h.pace[paceClass].maxTime = 0;
+	nextionHMI_h.pace[paceClass].samples = 0;
+}
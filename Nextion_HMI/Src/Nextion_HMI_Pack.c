@@ -0,0 +1,243 @@
+/*
+ * Nextion_HMI_Pack.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: György Kovács
+ *
+ *      Packed updates, several numeric values in global variables, unpacked by a script of the HMI project
+ */
+
+#include "Nextion_HMI.h"
+
+//PRIVATE FUNCTION PROTOTYPES//
+static uint32_t packClamp(int32_t value, uint8_t bits);
+static uint8_t packAppend(char *pDst, uint16_t size, uint16_t *pLength, const char *text, uint16_t textLength);
+
+/**
+ * @brief Add a numeric component to a packed update
+ * @note  The fields are placed in the order of adding, a field doesn't cross a variable.
+ * 		  The layout must match the unpack script, see NxHmi_PackScript().
+ *
+ * @param *pPack = packed update handler, global variable with the names of the variables
+ * @param *pOb_handle = Nextion object handler
+ * @param bits = width of the field, 1-32, the values are clamped to 0 - (2^bits - 1)
+ * @retval 	STAT_ERROR	= invalid width or NEX_PACK_FIELDS fields added already
+ * 			STAT_FAILED = the field doesn't fit into the variables
+ * 			STAT_OK 	= field is added
+ */
+Ret_Status_t NxHmi_PackField(Nextion_Pack_t *pPack, Nextion_Object_t *pOb_handle, uint8_t bits) {
+	Nextion_PackField_t *pField;
+	uint8_t word = 0;
+	uint8_t shift = 0;
+
+	if( (bits == 0) || (bits > 32) || (pPack->count >= NEX_PACK_FIELDS) ) {
+		return STAT_ERROR;
+	}
+
+	if(pPack->count > 0) {
+		//Right after the previous field, or in the next variable
+		pField = &pPack->fields[pPack->count - 1];
+		word = pField->word;
+		shift = pField->shift + pField->bits;
+		if( (shift + bits) > 32 ) {
+			word++;
+			shift = 0;
+		}
+	}
+	if( (word >= NEX_PACK_WORDS) || (pPack->Vars[word] == NULL) ) {
+		return STAT_FAILED;
+	}
+
+	pField = &pPack->fields[pPack->count];
+	pField->pObject = pOb_handle;
+	pField->bits = bits;
+	pField->word = word;
+	pField->shift = shift;
+	pPack->count++;
+	pPack->sentValid = 0;
+
+	return STAT_OK;
+}
+
+/**
+ * @brief Update every component of a packed update
+ * @note  With a verified unpack script on the current page the changed variables and
+ * 		  the trigger of the script are sent in one burst, e.g. 12 readouts of 8 bits
+ * 		  in 3 variables instead of 12 commands. Without it (or on another page),
+ * 		  the values are set one by one, the shadow cache skips the unchanged ones.
+ *
+ * @param *pPack = packed update handler
+ * @param *pValues = values in the order of the fields
+ * @retval see @ref HmiSendAndWait() function for return value, the first failed one in fallback
+ */
+Ret_Status_t NxHmi_PackUpdate(Nextion_Pack_t *pPack, const int32_t *pValues) {
+	uint32_t words[NEX_PACK_WORDS] = { 0 };
+	Nextion_PackField_t *pField;
+	Nextion_TxBuffer_t *pTxBuff;
+	Ret_Status_t retStatus = STAT_OK;
+	Ret_Status_t tmpRet;
+	uint8_t wordCount;
+	uint8_t changed = 0;
+	uint8_t cmdCount = 0;
+
+	if(pPack->count == 0) {
+		return STAT_OK;
+	}
+
+	if(!macroReady(pPack->pMacro)) {
+		//No unpack script, value by value
+		pPack->fallbackCnt++;
+		for(uint8_t i = 0; i < pPack->count; i++) {
+			tmpRet = setObjectProp(pPack->fields[i].pObject, SHADOW_VAL, pValues[i]);
+			if( (tmpRet != STAT_OK) && (retStatus == STAT_OK) ) {
+				retStatus = tmpRet;
+			}
+		}//end for loop
+		return retStatus;
+	}
+
+	if(pPack->generation != nextionHMI_h.shadowGeneration) {
+		//Page change or reset, the components are reloaded, run the script again
+		pPack->generation = nextionHMI_h.shadowGeneration;
+		pPack->sentValid = 0;
+	}
+
+	for(uint8_t i = 0; i < pPack->count; i++) {
+		pField = &pPack->fields[i];
+		words[pField->word] |= packClamp(pValues[i], pField->bits) << pField->shift;
+	}//end for loop
+	wordCount = pPack->fields[pPack->count - 1].word + 1U;
+	for(uint8_t w = 0; w < wordCount; w++) {
+		if( (!(pPack->sentValid & (1U << w))) || (pPack->sent[w] != words[w]) ) {
+			changed |= (1U << w);
+		}
+	}//end for loop
+	if(changed == 0) {
+		nextionHMI_h.elidedCnt++;
+		return STAT_OK;
+	}
+
+	pTxBuff = prepareToSend(0);
+	for(uint8_t w = 0; w < wordCount; w++) {
+		if(changed & (1U << w)) {
+			encodeText(pTxBuff, pPack->Vars[w]);
+			encodeChar(pTxBuff, '=');
+			encodeInt(pTxBuff, (int32_t)words[w]);
+			encodeData(pTxBuff, (const uint8_t*)"\xFF\xFF\xFF", 3);
+			cmdCount++;
+		}
+	}//end for loop
+	macroEncodeTrigger(pTxBuff, pPack->pMacro);
+	//Every command of the burst is answered, see txEngineCollectLane()
+	pTxBuff->cmdCount = cmdCount + 1U;
+	retStatus = HmiSendAndWait(pTxBuff, EXPECT_ACK, NULL);
+
+	if(retStatus == STAT_OK) {
+		memcpy(pPack->sent, words, sizeof(pPack->sent));
+		pPack->sentValid |= changed;
+		pPack->packedCnt++;
+	} else {
+		pPack->sentValid &= ~changed;
+	}
+	//The components are set by the script, keep their shadows in sync
+	for(uint8_t i = 0; i < pPack->count; i++) {
+		pField = &pPack->fields[i];
+		shadowUpdate(pField->pObject, SHADOW_VAL, packClamp(pValues[i], pField->bits), retStatus);
+	}//end for loop
+
+	return retStatus;
+}
+
+/**
+ * @brief Generate the unpack script of a packed update
+ * @note  Paste it into the Touch Press Event of the hotspot or the Timer Event of the timer.
+ * 		  Nextion evaluates from left to right, e.g. "n1.val=sys0>>8&255"
+ *
+ * @param *pPack = packed update handler, with its fields
+ * @param *pDst = destination buffer, zero terminated
+ * @param size = size of the buffer
+ * @retval length of the script, 0 if the buffer is too small
+ */
+uint16_t NxHmi_PackScript(const Nextion_Pack_t *pPack, char *pDst, uint16_t size) {
+	const Nextion_PackField_t *pField;
+	char number[11];
+	uint16_t length = 0;
+	uint8_t fits = 1;
+
+	if(size == 0) {
+		return 0;
+	}
+
+	for(uint8_t i = 0; (i < pPack->count) && fits; i++) {
+		pField = &pPack->fields[i];
+		fits = packAppend(pDst, size, &length, pField->pObject->Name, strlen(pField->pObject->Name)) &&
+			   packAppend(pDst, size, &length, ".val=", 5) &&
+			   packAppend(pDst, size, &length, pPack->Vars[pField->word], strlen(pPack->Vars[pField->word]));
+		if(fits && (pField->shift > 0)) {
+			fits = packAppend(pDst, size, &length, ">>", 2) &&
+				   packAppend(pDst, size, &length, number, formatUint(number, pField->shift));
+		}
+		if(fits && (pField->bits < 32)) {
+			fits = packAppend(pDst, size, &length, "&", 1) &&
+				   packAppend(pDst, size, &length, number, formatUint(number, (1UL << pField->bits) - 1UL));
+		}
+		fits = fits && packAppend(pDst, size, &length, "\r\n", 2);
+	}//end for loop
+
+	if( fits && (pPack->pMacro != NULL) && (pPack->pMacro->trigger == MACRO_TRIGGER_TIMER) ) {
+		//One run per update
+		fits = packAppend(pDst, size, &length, pPack->pMacro->Name, strlen(pPack->pMacro->Name)) &&
+			   packAppend(pDst, size, &length, ".en=0\r\n", 7);
+	}
+
+	if(!fits) {
+		pDst[0] = '\0';
+		return 0;
+	}
+	pDst[length] = '\0';
+	return length;
+}
+
+//////////////////////////STATIC FUNCTIONS////////////////////////////
+
+/**
+ * @brief Clamp a value to the range of a field
+ * @note  --
+ *
+ * @param value = value of the component
+ * @param bits = width of the field
+ * @retval value in 0 - (2^bits - 1), a 32 bit field is not clamped
+ */
+static uint32_t packClamp(int32_t value, uint8_t bits) {
+	uint32_t maxValue;
+
+	if(bits >= 32) {
+		return (uint32_t)value;
+	}
+	maxValue = (1UL << bits) - 1UL;
+	if(value < 0) {
+		return 0;
+	}
+	return ((uint32_t)value > maxValue) ? maxValue : (uint32_t)value;
+}
+
+/**
+ * @brief Append a text to the script
+ * @note  Room is kept for the terminating zero
+ *
+ * @param *pDst = destination buffer
+ * @param size = size of the buffer
+ * @param *pLength = length of the script, updated
+ * @param *text = text to append
+ * @param textLength = length of the text
+ * @retval 1 - appended, 0 - the buffer is too small
+ */
+static uint8_t packAppend(char *pDst, uint16_t size, uint16_t *pLength, const char *text, uint16_t textLength) {
+
+	if( ((uint32_t)*pLength + textLength) >= size ) {
+		return 0;
+	}
+	memcpy(&pDst[*pLength], text, textLength);
+	*pLength += textLength;
+	return 1;
+}
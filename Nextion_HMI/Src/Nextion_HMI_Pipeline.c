@@ -0,0 +1,407 @@
+/*
+ * Nextion_HMI_Pipeline.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: György Kovács
+ *
+ *      Expectation list of the commands in flight, matching the answers to the commands
+ */
+
+#include "Nextion_HMI.h"
+
+//PRIVATE FUNCTION PROTOTYPES//
+static void expectComplete(Nextion_Token_t *pToken, Ret_Status_t status, Ret_Command_t *pCommand);
+
+/**
+ * @brief Clear the expectation list and create its timeout timer
+ * @note  Called from NxHmi_Init(), BEFORE osKernelStart()
+ *
+ * @param void
+ * @retval void
+ */
+void expectInit(void) {
+	nextionHMI_h.expectHead = 0;
+	nextionHMI_h.expectCount = 0;
+	nextionHMI_h.expectTimeoutCnt = 0;
+
+	nextionHMI_h.expectTimer = xTimerCreate("Expect",
+									NEX_ANSW_TIMEOUT / 4, // Check the oldest answer 4 times in a timeout period
+									pdTRUE,         // Auto-reload timer
+									( void * )0,
+									(TimerCallbackFunction_t) expectTimerCallback
+									);
+}
+
+/**
+ * @brief Number of free entries in the expectation list
+ * @note  A command which expects an answer can be sent only if there is room for it
+ *
+ * @param void
+ * @retval free entries
+ */
+uint8_t expectFree(void) {
+	return NEX_PIPELINE_DEPTH - nextionHMI_h.expectCount;
+}
+
+/**
+ * @brief Add a command to the end of the expectation list
+ * @note  Called by the line holder of the TX engine, in the order of transmission
+ *
+ * @param kind = expected answer
+ * @param paceClass = class of the command, for the learning of its processing time
+ * @param *pToken = completion token, or NULL
+ * @param xTimeSent = expected end of the transmission of the command
+ * @retval void
+ */
+void expectPush(Nx_Expect_t kind, Nx_Pace_Class_t paceClass, Nextion_Token_t *pToken, TickType_t xTimeSent) {
+	Nextion_Expect_t *pEntry;
+	uint8_t wasEmpty;
+
+	taskENTER_CRITICAL();
+	pEntry = &nextionHMI_h.expectList[(nextionHMI_h.expectHead + nextionHMI_h.expectCount) % NEX_PIPELINE_DEPTH];
+	pEntry->kind = kind;
+	pEntry->pToken = pToken;
+	pEntry->paceClass = paceClass;
+	pEntry->xTimeSent = xTimeSent;
+	pEntry->pShadowObject = NULL;
+	wasEmpty = (nextionHMI_h.expectCount == 0);
+	nextionHMI_h.expectCount++;
+	taskEXIT_CRITICAL();
+
+	if(wasEmpty) {
+		xTimerStart(nextionHMI_h.expectTimer, 0);
+	}
+}
+
+/**
+ * @brief Bind the last added command to the shadow cache of the written property
+ * @note  Called by the line holder right after expectPush(), before the burst is transmitted.
+ * 		  The cache is settled with the final status of the command, see shadowSettle().
+ *
+ * @param *pOb_handle = written object, NULL if none
+ * @param prop = written property
+ * @retval void
+ */
+void expectBindShadow(Nextion_Object_t *pOb_handle, Nx_Shadow_Prop_t prop) {
+	Nextion_Expect_t *pEntry;
+
+	taskENTER_CRITICAL();
+	pEntry = &nextionHMI_h.expectList[(nextionHMI_h.expectHead + nextionHMI_h.expectCount - 1) % NEX_PIPELINE_DEPTH];
+	pEntry->pShadowObject = pOb_handle;
+	pEntry->shadowProp = prop;
+	taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief Remove the last commands from the expectation list
+ * @note  Used when a collected burst could not be transmitted
+ *
+ * @param count = number of commands
+ * @param status = result reported to the tokens
+ * @retval void
+ */
+void expectDropLast(uint8_t count, Ret_Status_t status) {
+	Nextion_Expect_t *pEntry;
+	Nextion_Token_t *pToken;
+
+	while(count-- > 0) {
+		taskENTER_CRITICAL();
+		if(nextionHMI_h.expectCount == 0) {
+			taskEXIT_CRITICAL();
+			return;
+		}
+		nextionHMI_h.expectCount--;
+		pEntry = &nextionHMI_h.expectList[(nextionHMI_h.expectHead + nextionHMI_h.expectCount) % NEX_PIPELINE_DEPTH];
+		pToken = pEntry->pToken;
+		shadowSettle(pEntry->pShadowObject, pEntry->shadowProp, status);
+		taskEXIT_CRITICAL();
+
+		expectComplete(pToken, status, NULL);
+	}//end while loop
+}
+
+/**
+ * @brief Match an incoming frame to the command it answers
+ * @note  Called from the RX task. The display executes the commands in order:
+ * 		  - an error code answers the oldest command,
+ * 		  - a success answers the oldest command if it expects a success,
+ * 		  - a data frame answers the oldest command of the same kind, the commands before it
+ * 		    are done (success is not reported with bkcmd < 3),
+ * 		  - a raw number is passed as numeric data, it answers the oldest EXPECT_RAW or EXPECT_NUMBER.
+ *
+ * @param *pCommand = parsed frame, cmdCode is 0x00 for errors
+ * @retval 1 - the frame answered a command, 0 - unsolicited frame, pass it to waitForAnswer()
+ */
+uint8_t expectMatch(Ret_Command_t *pCommand) {
+	Nextion_Token_t *pDone[NEX_PIPELINE_DEPTH];
+	Ret_Status_t doneStatus[NEX_PIPELINE_DEPTH];
+	uint8_t doneCount = 0;
+	uint8_t matched = 0;
+	Nextion_Expect_t *pEntry;
+	Nx_Expect_t kind;
+	Nx_Pace_Class_t paceClass = PACE_SET;
+	TickType_t xTimeSent = 0;
+
+	switch (pCommand->cmdCode) {
+		case 0x00:
+			kind = EXPECT_NONE; //error code, answers any kind
+			break;
+
+		case NEX_EVENT_SUCCESS:
+			kind = EXPECT_ACK;
+			break;
+
+		case NEX_RET_NUMBER_HEAD:
+			kind = EXPECT_NUMBER;
+			break;
+
+		case NEX_RET_STRING_HEAD:
+			kind = EXPECT_STRING;
+			break;
+
+		case NEX_RET_CURRENT_PAGEID_HEAD:
+			kind = EXPECT_PAGE;
+			break;
+
+		case NEX_EVENT_TRANSPARENT_READY:
+			kind = EXPECT_READY;
+			break;
+
+		case NEX_EVENT_TRANSPARENT_DONE:
+			kind = EXPECT_DONE;
+			break;
+
+		default:
+			return 0;
+	}//end switch
+
+	taskENTER_CRITICAL();
+	if(nextionHMI_h.expectCount > 0) {
+		pEntry = &nextionHMI_h.expectList[nextionHMI_h.expectHead];
+
+		if(kind == EXPECT_NONE) {
+			pDone[doneCount] = pEntry->pToken;
+			doneStatus[doneCount++] = STAT_FAILED;
+			matched = 1;
+
+		} else if(kind == EXPECT_ACK) {
+			if(pEntry->kind == EXPECT_ACK) {
+				pDone[doneCount] = pEntry->pToken;
+				doneStatus[doneCount++] = STAT_OK;
+				matched = 1;
+			}
+
+		} else {
+			//Find the oldest command which waits for this data
+			for(uint8_t i = 0; i < nextionHMI_h.expectCount; i++) {
+				pEntry = &nextionHMI_h.expectList[(nextionHMI_h.expectHead + i) % NEX_PIPELINE_DEPTH];
+				if( (pEntry->kind == kind) || ((kind == EXPECT_NUMBER) && (pEntry->kind == EXPECT_RAW)) ) {
+					matched = i + 1;
+					break;
+				}
+			}//end for loop
+
+			for(uint8_t i = 0; i < matched; i++) {
+				pEntry = &nextionHMI_h.expectList[(nextionHMI_h.expectHead + i) % NEX_PIPELINE_DEPTH];
+				pDone[doneCount] = pEntry->pToken;
+				//A data request skipped by the display has failed
+				doneStatus[doneCount++] = ( (pEntry->kind == EXPECT_ACK) || (i == matched - 1) ) ? STAT_OK : STAT_FAILED;
+			}//end for loop
+		}//end if kind
+
+		for(uint8_t i = 0; i < doneCount; i++) {
+			pEntry = &nextionHMI_h.expectList[(nextionHMI_h.expectHead + i) % NEX_PIPELINE_DEPTH];
+			shadowSettle(pEntry->pShadowObject, pEntry->shadowProp, doneStatus[i]);
+		}//end for loop
+		if(doneCount > 0) {
+			//The answered command, the ones before it have not been answered separately
+			pEntry = &nextionHMI_h.expectList[(nextionHMI_h.expectHead + doneCount - 1) % NEX_PIPELINE_DEPTH];
+			paceClass = pEntry->paceClass;
+			xTimeSent = pEntry->xTimeSent;
+		}
+		nextionHMI_h.expectHead = (nextionHMI_h.expectHead + doneCount) % NEX_PIPELINE_DEPTH;
+		nextionHMI_h.expectCount -= doneCount;
+	}
+	taskEXIT_CRITICAL();
+
+	if( (doneCount > 0) && (kind != EXPECT_NONE) && (nextionHMI_h.ifaceVerbose == 3) ) {
+		//Below level 3 the commands answered silently hide the start of this one,
+		//  an error answer comes before the execution, both would distort the estimate
+		paceLearn(paceClass, xTimeSent);
+	}
+
+	for(uint8_t i = 0; i < doneCount; i++) {
+		//Only the last one gets the data
+		expectComplete(pDone[i], doneStatus[i], (i == doneCount - 1) ? pCommand : NULL);
+	}//end for loop
+
+	if(doneCount > 0) {
+		//Room for the next commands
+		txEngineKick();
+	}
+	return (matched > 0);
+}
+
+/**
+ * @brief Expected kind of the next frame
+ * @note  Called by the protocol parser at the first byte of a frame. The answer of the oldest
+ * 		  command comes first, a command which expects a success is skipped if the success is
+ * 		  not reported (bkcmd 0 or 2). The raw numbers are decoded by it, see RX_STATE_RAW.
+ *
+ * @param void
+ * @retval kind of the oldest command in flight, EXPECT_NONE if no answer is expected
+ */
+Nx_Expect_t expectNext(void) {
+	Nx_Expect_t kind = EXPECT_NONE;
+	uint8_t skipAck = (nextionHMI_h.ifaceVerbose != 1) && (nextionHMI_h.ifaceVerbose != 3);
+
+	taskENTER_CRITICAL();
+	for(uint8_t i = 0; i < nextionHMI_h.expectCount; i++) {
+		kind = nextionHMI_h.expectList[(nextionHMI_h.expectHead + i) % NEX_PIPELINE_DEPTH].kind;
+		if( (kind != EXPECT_ACK) || (!skipAck) ) {
+			break;
+		}
+		kind = EXPECT_NONE;
+	}//end for loop
+	taskEXIT_CRITICAL();
+
+	return kind;
+}
+
+/**
+ * @brief Complete the commands which expect a success answer
+ * @note  Called from the TX timer callback when the line is quiet after a burst.
+ * 		  With bkcmd < 3 the success is not reported, no error arrived, so they are done.
+ *
+ * @param void
+ * @retval void
+ */
+void expectResolveQuiet(void) {
+	Nextion_Token_t *pDone[NEX_PIPELINE_DEPTH];
+	Nextion_Expect_t *pEntry;
+	uint8_t doneCount = 0;
+	uint8_t keepCount = 0;
+
+	taskENTER_CRITICAL();
+	for(uint8_t i = 0; i < nextionHMI_h.expectCount; i++) {
+		pEntry = &nextionHMI_h.expectList[(nextionHMI_h.expectHead + i) % NEX_PIPELINE_DEPTH];
+		if(pEntry->kind == EXPECT_ACK) {
+			pDone[doneCount++] = pEntry->pToken;
+			shadowSettle(pEntry->pShadowObject, pEntry->shadowProp, STAT_OK);
+		} else {
+			//Keep the data requests, in order
+			nextionHMI_h.expectList[(nextionHMI_h.expectHead + keepCount++) % NEX_PIPELINE_DEPTH] = *pEntry;
+		}
+	}//end for loop
+	nextionHMI_h.expectCount = keepCount;
+	taskEXIT_CRITICAL();
+
+	for(uint8_t i = 0; i < doneCount; i++) {
+		expectComplete(pDone[i], STAT_OK, NULL);
+	}//end for loop
+}
+
+/**
+ * @brief Complete every command of the expectation list
+ * @note  Called when the display is reseted, no answer will arrive
+ *
+ * @param status = result reported to the tokens
+ * @retval void
+ */
+void expectFlush(Ret_Status_t status) {
+	Nextion_Expect_t *pEntry;
+	Nextion_Token_t *pToken;
+
+	while(1) {
+		taskENTER_CRITICAL();
+		if(nextionHMI_h.expectCount == 0) {
+			taskEXIT_CRITICAL();
+			return;
+		}
+		pEntry = &nextionHMI_h.expectList[nextionHMI_h.expectHead];
+		pToken = pEntry->pToken;
+		shadowSettle(pEntry->pShadowObject, pEntry->shadowProp, status);
+		nextionHMI_h.expectHead = (nextionHMI_h.expectHead + 1) % NEX_PIPELINE_DEPTH;
+		nextionHMI_h.expectCount--;
+		taskEXIT_CRITICAL();
+
+		expectComplete(pToken, status, NULL);
+	}//end while loop
+}
+
+/**
+ * @brief Expectation timer Callback
+ * @note  Drop the commands whose answer has not arrived in NEX_ANSW_TIMEOUT
+ *
+ * @param *argument
+ * @retval void
+ */
+void expectTimerCallback(void *argument) {
+	Nextion_Expect_t *pEntry;
+	Nextion_Token_t *pToken;
+	uint8_t expired = 0;
+
+	while(1) {
+		taskENTER_CRITICAL();
+		if( (nextionHMI_h.expectCount == 0) ||
+			( (int32_t)(xTaskGetTickCount() - nextionHMI_h.expectList[nextionHMI_h.expectHead].xTimeSent) < (int32_t)NEX_ANSW_TIMEOUT ) ) {
+			taskEXIT_CRITICAL();
+			break;
+		}
+		pEntry = &nextionHMI_h.expectList[nextionHMI_h.expectHead];
+		pToken = pEntry->pToken;
+		shadowSettle(pEntry->pShadowObject, pEntry->shadowProp, STAT_TIMEOUT);
+		nextionHMI_h.expectHead = (nextionHMI_h.expectHead + 1) % NEX_PIPELINE_DEPTH;
+		nextionHMI_h.expectCount--;
+		nextionHMI_h.expectTimeoutCnt++;
+		taskEXIT_CRITICAL();
+
+		expectComplete(pToken, STAT_TIMEOUT, NULL);
+		expired++;
+	}//end while loop
+
+	if(nextionHMI_h.expectCount == 0) {
+		xTimerStop(nextionHMI_h.expectTimer, 0);
+	}
+	if(expired) {
+		//Room for the next commands
+		txEngineKick();
+	}
+}
+
+/**
+ * @brief Number of commands whose answer has not arrived
+ * @note  Their token is completed with STAT_TIMEOUT
+ *
+ * @param void
+ * @retval Number of answer timeouts since NxHmi_Init()
+ */
+uint32_t NxHmi_GetAnswerTimeoutCount(void) {
+	return nextionHMI_h.expectTimeoutCnt;
+}
+
+//////////////////////////STATIC FUNCTIONS////////////////////////////
+
+/**
+ * @brief Report the result of a command
+ * @note  --
+ *
+ * @param *pToken = completion token, can be NULL
+ * @param status = result of the command
+ * @param *pCommand = returned data, or NULL. Its string is borrowed by pResult of the token
+ * @retval void
+ */
+static void expectComplete(Nextion_Token_t *pToken, Ret_Status_t status, Ret_Command_t *pCommand) {
+
+	if( (pCommand != NULL) && ((pToken == NULL) || (pToken->pResult == NULL)) ) {
+		//Nobody takes the returned string
+		NxHmi_ReleaseText(pCommand->stringData);
+	}
+	if(pToken == NULL) {
+		return;
+	}
+	if( (pCommand != NULL) && (pToken->pResult != NULL) ) {
+		*pToken->pResult = *pCommand;
+	}
+	tokenComplete(pToken, status);
+}
@@ -0,0 +1,342 @@
+/*
+ * Nextion_HMI_Rx.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: György Kovács
+ *
+ *      RX ring filled by circular DMA, byte oriented protocol parser
+ */
+
+#include "Nextion_HMI.h"
+
+//PRIVATE FUNCTION PROTOTYPES//
+static uint8_t rxParseByte(uint8_t byte);
+static uint8_t rxParseString(uint8_t byte);
+static uint8_t rxFrameLength(uint8_t head);
+static void rxRawNumber(void);
+static uint16_t rxPending(void);
+static uint8_t rxOverrun(void);
+static uint8_t rxPeek(void);
+
+/**
+ * @brief Start the circular DMA reception of the RX ring
+ * @note  Every idle line, half and full ring wakes up the RX task, no per byte interrupt.
+ * 		  The received bytes and the frame under reception are dropped.
+ * 		  Called from the RX task only, at start and at the requests of rxRestart.
+ *
+ * @param void
+ * @retval void
+ */
+void rxStart(void) {
+
+	nextionHMI_h.rxHead = nextionHMI_h.rxTail = 0;
+	nextionHMI_h.rxDmaPos = 0;
+	nextionHMI_h.rxIdle = 0;
+	nextionHMI_h.rxParser.state = RX_STATE_HEAD;
+	NxHmi_ReleaseText(nextionHMI_h.rxParser.pString);
+	nextionHMI_h.rxParser.pString = NULL;
+	if(HAL_UARTEx_ReceiveToIdle_DMA(nextionHMI_h.pUart, nextionHMI_h.rxBuff, NEX_RX_BUFF_SIZE) != HAL_OK) {
+		//Try again at the next UART error
+		nextionHMI_h.errorCnt++;
+	}
+}
+
+/**
+ * @brief Feed the received bytes into the protocol parser
+ * @note  Called by the RX task at every RX event. The bytes are taken one by one,
+ * 		  a frame is passed to validateCommand() as soon as its last byte is parsed,
+ * 		  a frame split across the RX events is continued at the next one.
+ *
+ * @param void
+ * @retval void
+ */
+void rxProcess(void) {
+	uint16_t pending;
+	uint8_t length;
+	uint8_t byte;
+
+	while( (pending = rxPending()) > 0 ) {
+		for( ; pending > 0; pending--) {
+			byte = rxPeek();
+			if(rxOverrun()) {
+				//The byte may have been overwritten, resynchronize at the next terminator
+				nextionHMI_h.rxParser.state = RX_STATE_SKIP;
+				nextionHMI_h.rxParser.termCnt = 0;
+				break;
+			}
+			nextionHMI_h.rxTail++;
+
+			length = rxParseByte(byte);
+			if(length > 0) {
+				nextionHMI_h.cmdCnt++;
+				validateCommand(nextionHMI_h.rxParser.frame, length);
+			}
+		}//end for loop
+	}//end while loop
+
+	rxRawNumber();
+}
+
+/**
+ * @brief Take the string of the last parsed 0x70 frame
+ * @note  Called from validateCommand(), the caller owns the block,
+ * 		  it's released by the receiver of the string with NxHmi_ReleaseText()
+ *
+ * @param *pLength = length of the string
+ * @retval zero terminated string in a block of the arena, NULL if no block was free
+ */
+char *rxTakeString(uint16_t *pLength) {
+	Nextion_RxParser_t *pParser = &nextionHMI_h.rxParser;
+	char *pString = pParser->pString;
+
+	pParser->pString = NULL;
+	*pLength = (pString != NULL) ? pParser->stringLength : 0;
+	return pString;
+}
+
+//////////////////////////STATIC FUNCTIONS////////////////////////////
+
+/**
+ * @brief Parse a received byte
+ * @note  The length of the frames with a head of fixed length is known,
+ * 		  the other ones are ended by the terminator (0xFF 0xFF 0xFF).
+ * 		  If the oldest command in flight expects a raw number, the next 4 bytes are the number.
+ *
+ * @param byte = received byte
+ * @retval length of the completed frame without the terminator, 0 - the frame is not completed
+ */
+static uint8_t rxParseByte(uint8_t byte) {
+	Nextion_RxParser_t *pParser = &nextionHMI_h.rxParser;
+
+	if(pParser->state == RX_STATE_HEAD) {
+		pParser->length = pParser->termCnt = 0;
+		if(expectNext() == EXPECT_RAW) {
+			//Answer of prints <var>,4, any value, 0xFF bytes as well. Passed as a 0x71 frame
+			pParser->frame[pParser->length++] = NEX_RET_NUMBER_HEAD;
+			pParser->state = RX_STATE_RAW;
+		} else if(byte == 0xFF) {
+			//Terminator without frame
+			nextionHMI_h.errorCnt++;
+			return 0;
+		} else if(byte == NEX_RET_STRING_HEAD) {
+			//A block left by a dropped string is reused
+			if(pParser->pString == NULL) {
+				pParser->pString = stringAlloc();
+			}
+			pParser->stringLength = 0;
+			pParser->frame[pParser->length++] = byte;
+			pParser->state = RX_STATE_STRING;
+			return 0;
+		} else {
+			pParser->frameLength = rxFrameLength(byte);
+			pParser->state = (pParser->frameLength > 0) ? RX_STATE_FIXED : RX_STATE_TERMINATED;
+		}
+	}
+
+	if(pParser->state == RX_STATE_RAW) {
+		pParser->frame[pParser->length++] = byte;
+		if(pParser->length < 5) {
+			return 0;
+		}
+		pParser->state = RX_STATE_HEAD;
+		if( (nextionHMI_h.ifaceVerbose >= 2) && (pParser->frame[2] == 0xFF) &&
+			(pParser->frame[3] == 0xFF) && (pParser->frame[4] == 0xFF) &&
+			( (pParser->frame[1] == NEX_RET_INVALID_CMD) || ((pParser->frame[1] > 0x01) && (pParser->frame[1] <= 0x23)) ) ) {
+			//<error code> 0xFF 0xFF 0xFF, the request has failed, see validateCommand()
+			pParser->frame[0] = pParser->frame[1];
+			return 1;
+		}
+		return pParser->length;
+	}
+
+	pParser->termCnt = (byte == 0xFF) ? (pParser->termCnt + 1U) : 0;
+
+	if(pParser->state == RX_STATE_STRING) {
+		return rxParseString(byte);
+	}
+
+	if( (pParser->state == RX_STATE_TERMINATED) && (pParser->length >= NEX_RX_FRAME_SIZE) ) {
+		//Too long, drop it
+		nextionHMI_h.errorCnt++;
+		pParser->state = RX_STATE_SKIP;
+	}
+	if(pParser->state == RX_STATE_SKIP) {
+		if(pParser->termCnt >= 3) {
+			pParser->state = RX_STATE_HEAD;
+		}
+		return 0;
+	}
+
+	pParser->frame[pParser->length++] = byte;
+
+	if(pParser->state == RX_STATE_FIXED) {
+		if(pParser->length < pParser->frameLength) {
+			return 0;
+		}
+		if( (pParser->termCnt < 3) && (pParser->length == 4) ) {
+			//Not a return code, can be raw data, see rxRawNumber()
+			pParser->state = RX_STATE_TERMINATED;
+			return 0;
+		}
+		if(pParser->termCnt < 3) {
+			//Wrong length or broken terminator
+			nextionHMI_h.errorCnt++;
+			pParser->state = RX_STATE_SKIP;
+			return 0;
+		}
+	} else if(pParser->termCnt < 3) {
+		return 0;
+	}
+
+	pParser->state = RX_STATE_HEAD;
+	return pParser->length - 3U;
+}
+
+/**
+ * @brief Parse a received byte of a string frame
+ * @note  The bytes are written straight into the arena block, a string longer than
+ * 		  the block is truncated. Without a free block the string is dropped.
+ *
+ * @param byte = received byte
+ * @retval 1 - the frame is completed, 0 - not completed
+ */
+static uint8_t rxParseString(uint8_t byte) {
+	Nextion_RxParser_t *pParser = &nextionHMI_h.rxParser;
+	uint16_t length;
+
+	if( (pParser->pString != NULL) && (pParser->stringLength < (NEX_STRING_BLOCK_SIZE - 1)) ) {
+		pParser->pString[pParser->stringLength] = (char)byte;
+	}
+	if(pParser->stringLength < UINT16_MAX) {
+		pParser->stringLength++;
+	}
+	if(pParser->termCnt < 3) {
+		return 0;
+	}
+
+	//The last 3 bytes are the terminator
+	length = pParser->stringLength - 3U;
+	if( (pParser->pString == NULL) || (length > (NEX_STRING_BLOCK_SIZE - 1)) ) {
+		nextionHMI_h.stringDropCnt++;
+	}
+	pParser->stringLength = (length < NEX_STRING_BLOCK_SIZE) ? length : (NEX_STRING_BLOCK_SIZE - 1);
+	if(pParser->pString != NULL) {
+		pParser->pString[pParser->stringLength] = '\0';
+	}
+	pParser->state = RX_STATE_HEAD;
+	return 1;
+}
+
+/**
+ * @brief Length of a frame from its first byte
+ * @note  The payload of the fixed frames can contain 0xFF, e.g. a number of 0x71
+ *
+ * @param head = first byte of the frame
+ * @retval length with the terminator, 0 - ended by the terminator
+ */
+static uint8_t rxFrameLength(uint8_t head) {
+
+	switch (head) {
+		case NEX_EVENT_TOUCH_HEAD:
+			return 7;	//page id, component id, event
+
+		case NEX_RET_CURRENT_PAGEID_HEAD:
+			return 5;	//page id
+
+		case NEX_EVENT_POSITION_HEAD:
+		case NEX_EVENT_SLEEP_POSITION_HEAD:
+			return 9;	//x, y and event
+
+		case NEX_RET_NUMBER_HEAD:
+			return 8;	//32 bit number
+
+		case NEX_RET_INVALID_CMD:	//0x00 0xFF.. invalid instruction or 0x00 0x00 0x00 0xFF.. startup
+			return 0;
+
+		default:
+			return 4;	//return codes and events without data
+	}//end switch
+}
+
+/**
+ * @brief Identification of unsolicited raw data at the end of a stream
+ * @note  RAW data sent in 4 byte 32-bit little endian order, without head and terminator.
+ * 		  The answers of the requests are decoded by their expectation, see RX_STATE_RAW.
+ * 		  With no answer expected (e.g. prints of a script of the display), a 4 byte frame,
+ * 		  not completed when the line went idle, is likely to be raw data.
+ * @param void
+ * @retval void
+ */
+static void rxRawNumber(void) {
+	Nextion_RxParser_t *pParser = &nextionHMI_h.rxParser;
+	uint8_t cmdBuff[5];
+
+	if( (!nextionHMI_h.rxIdle) || (expectNext() != EXPECT_NONE) ) {
+		return;
+	}
+	if( (pParser->state == RX_STATE_STRING) && (pParser->pString != NULL) && (pParser->stringLength == 3) ) {
+		//The first byte is the head of a string
+		memcpy(&pParser->frame[1], pParser->pString, 3);
+	} else if( (pParser->state != RX_STATE_FIXED) && (pParser->state != RX_STATE_TERMINATED) ) {
+		return;
+	} else if(pParser->length != 4) {
+		return;
+	}
+	if(pParser->termCnt >= 3) {
+		//A value of 0xFFFFFF00 or more can't be told from a return code, it's taken as a return code.
+		//Request such values with NxHmi_GetObjRawValue(), its answer is decoded by the expectation.
+		return;
+	}
+
+	cmdBuff[0] = NEX_RET_NUMBER_HEAD;
+	memcpy(&cmdBuff[1], pParser->frame, 4);
+	pParser->state = RX_STATE_HEAD;
+	nextionHMI_h.cmdCnt++;
+	validateCommand(cmdBuff, sizeof(cmdBuff));
+}
+
+/**
+ * @brief Number of received bytes in the RX ring
+ * @note  The indexes are free running, their difference is valid across the wrap around.
+ * 		  The bytes are read after the head, see the barrier.
+ *
+ * @param void
+ * @retval bytes between the read and the write position
+ */
+static uint16_t rxPending(void) {
+	uint32_t head = nextionHMI_h.rxHead;
+
+	__DMB();
+	return (uint16_t)(head - nextionHMI_h.rxTail);
+}
+
+/**
+ * @brief Check if the DMA has overwritten the unparsed bytes
+ * @note  The DMA runs ahead of the last RX event by max. half ring,
+ * 		  the bytes are safe while no more than half ring is pending. Otherwise they are dropped.
+ *
+ * @param void
+ * @retval 1 - overrun, the RX ring is dropped, 0 - the pending bytes are valid
+ */
+static uint8_t rxOverrun(void) {
+	uint32_t head = nextionHMI_h.rxHead;
+
+	if( (head - nextionHMI_h.rxTail) <= (NEX_RX_BUFF_SIZE / 2) ) {
+		return 0;
+	}
+	nextionHMI_h.rxTail = head;
+	nextionHMI_h.rxOverrunCnt++;
+	nextionHMI_h.errorCnt++;
+	return 1;
+}
+
+/**
+ * @brief Read the next received byte without taking it
+ * @note  --
+ *
+ * @param void
+ * @retval received byte
+ */
+static uint8_t rxPeek(void) {
+	return nextionHMI_h.rxBuff[nextionHMI_h.rxTail & RX_RING_MASK];
+}
@@ -0,0 +1,214 @@
+/*
+ * Nextion_HMI_Shadow.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: György Kovács
+ *
+ *      Shadow cache of the object properties, skip redundant writes
+ */
+
+#include "Nextion_HMI.h"
+
+
+/**
+ * @brief Attach a shadow cache to a Nextion object
+ * @note  The cache must stay valid as long as the object is used (global or static variable).
+ * 		  Don't attach it to components which are changed on the display (e.g. slider by touch),
+ * 		  or invalidate it from their callback.
+ *
+ * @param *pOb_handle = Nextion object handler
+ * @param *pShadow = shadow cache, NULL to detach
+ * @retval void
+ */
+void NxHmi_AttachShadow(Nextion_Object_t *pOb_handle, Nextion_Shadow_t *pShadow) {
+	if(pShadow != NULL) {
+		memset(pShadow, 0x00, sizeof(Nextion_Shadow_t));
+		pShadow->generation = nextionHMI_h.shadowGeneration;
+	}
+	pOb_handle->pShadow = pShadow;
+}
+
+/**
+ * @brief Forget the cached values of an object
+ * @note  The next write is always sent
+ *
+ * @param *pOb_handle = Nextion object handler
+ * @retval void
+ */
+void NxHmi_ShadowInvalidate(Nextion_Object_t *pOb_handle) {
+	if(pOb_handle->pShadow != NULL) {
+		pOb_handle->pShadow->validMask = 0;
+	}
+}
+
+/**
+ * @brief Forget the cached values of every object
+ * @note  Called on page change and reset, the display reloads the components then.
+ * 		  Call it if the page is changed on the display side.
+ *
+ * @param void
+ * @retval void
+ */
+void NxHmi_ShadowInvalidateAll(void) {
+	nextionHMI_h.shadowGeneration++;
+}
+
+/**
+ * @brief Number of writes skipped by the shadow cache
+ * @note  Per object counter: pOb_handle->pShadow->elidedCnt
+ *
+ * @param void
+ * @retval Number of skipped writes since NxHmi_Init()
+ */
+uint32_t NxHmi_GetElidedCount(void) {
+	return nextionHMI_h.elidedCnt;
+}
+
+/**
+ * @brief Check if the display already shows the value
+ * @note  Count the skipped write if so
+ *
+ * @param *pOb_handle = Nextion object handler
+ * @param prop = property of the object
+ * @param value = new value, see shadowHashText() for text
+ * @retval 1 - same value is cached, skip the write, 0 - send it
+ */
+uint8_t shadowIsCached(Nextion_Object_t *pOb_handle, Nx_Shadow_Prop_t prop, uint32_t value) {
+	Nextion_Shadow_t *pShadow = pOb_handle->pShadow;
+
+	if(pShadow == NULL) {
+		return 0;
+	}
+
+	if(pShadow->generation != nextionHMI_h.shadowGeneration) {
+		//Page has been changed or the display has been reseted since
+		pShadow->validMask = 0;
+		pShadow->generation = nextionHMI_h.shadowGeneration;
+		return 0;
+	}
+
+	if( (pShadow->validMask & (1U << prop)) && (pShadow->value[prop] == value) ) {
+		pShadow->elidedCnt++;
+		nextionHMI_h.elidedCnt++;
+		return 1;
+	}
+	return 0;
+}
+
+/**
+ * @brief Update the cache with the result of a write
+ * @note  Store the value on success, forget it otherwise. Used by the writes which are
+ * 		  not bound to one staging buffer, see shadowQueue(). A newer queued write keeps its value.
+ *
+ * @param *pOb_handle = Nextion object handler
+ * @param prop = property of the object
+ * @param value = written value
+ * @param status = result of the write
+ * @retval status, passed through
+ */
+Ret_Status_t shadowUpdate(Nextion_Object_t *pOb_handle, Nx_Shadow_Prop_t prop, uint32_t value, Ret_Status_t status) {
+	Nextion_Shadow_t *pShadow = pOb_handle->pShadow;
+
+	if(pShadow != NULL) {
+		taskENTER_CRITICAL();
+		if(status != STAT_OK) {
+			pShadow->validMask &= ~(1U << prop);
+		} else if(pShadow->pendingCnt[prop] == 0) {
+			pShadow->value[prop] = value;
+			pShadow->validMask |= (1U << prop);
+		}
+		taskEXIT_CRITICAL();
+	}
+	return status;
+}
+
+/**
+ * @brief Bind a write to the cache before it is queued
+ * @note  The value is stored, but it is valid only when every queued write of the property
+ * 		  has been answered successfully, see shadowSettle(). The binding goes with the
+ * 		  staging buffer to the expectation list.
+ *
+ * @param *pTxBuff = staging buffer of the write, NULL if no buffer was available
+ * @param *pOb_handle = Nextion object handler
+ * @param prop = property of the object
+ * @param value = written value, see shadowHashText() for text
+ * @retval void
+ */
+void shadowQueue(Nextion_TxBuffer_t *pTxBuff, Nextion_Object_t *pOb_handle, Nx_Shadow_Prop_t prop, uint32_t value) {
+	Nextion_Shadow_t *pShadow = pOb_handle->pShadow;
+
+	if( (pTxBuff == NULL) || (pShadow == NULL) ) {
+		return;
+	}
+
+	taskENTER_CRITICAL();
+	pShadow->value[prop] = value;
+	pShadow->validMask &= ~(1U << prop);
+	pShadow->pendingCnt[prop]++;
+	taskEXIT_CRITICAL();
+
+	pTxBuff->pShadowObject = pOb_handle;
+	pTxBuff->shadowProp = prop;
+}
+
+/**
+ * @brief Settle the cache when a queued write is completed
+ * @note  Called with the final status of the command: from the expectation list,
+ * 		  or when the command is not queued. A failed write invalidates the property.
+ * 		  A write of an older page or reset generation doesn't make it valid.
+ *
+ * @param *pOb_handle = Nextion object handler, NULL if the command has no binding
+ * @param prop = property of the object
+ * @param status = result of the write
+ * @retval void
+ */
+void shadowSettle(Nextion_Object_t *pOb_handle, Nx_Shadow_Prop_t prop, Ret_Status_t status) {
+	Nextion_Shadow_t *pShadow;
+
+	if( (pOb_handle == NULL) || ((pShadow = pOb_handle->pShadow) == NULL) ) {
+		return;
+	}
+
+	taskENTER_CRITICAL();
+	if(pShadow->pendingCnt[prop] > 0) {
+		pShadow->pendingCnt[prop]--;
+	}
+	if(status != STAT_OK) {
+		pShadow->validMask &= ~(1U << prop);
+	} else if( (pShadow->pendingCnt[prop] == 0) && (pShadow->generation == nextionHMI_h.shadowGeneration) ) {
+		//The newest queued value is on the display
+		pShadow->validMask |= (1U << prop);
+	}
+	taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief 32bit FNV-1a hash of a text
+ * @note  Text values are cached as hash
+ *
+ * @param *text = string pointer
+ * @retval hash value
+ */
+uint32_t shadowHashText(const char *text) {
+	uint32_t hash = 2166136261U;
+
+	while(*text) {
+		hash ^= (uint8_t)*text++;
+		hash *= 16777619U;
+	}
+	return hash;
+}
+
+/**
+ * @brief Complete the token of a skipped async write
+ * @note  The callback is called from the calling task
+ *
+ * @param *pToken = completion token, can be NULL
+ * @retval STAT_OK
+ */
+Ret_Status_t shadowSkipAsync(Nextion_Token_t *pToken) {
+	if(pToken != NULL) {
+		tokenComplete(pToken, STAT_OK);
+	}
+	return STAT_OK;
+}
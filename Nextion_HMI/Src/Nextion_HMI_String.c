@@ -0,0 +1,69 @@
+/*
+ * Nextion_HMI_String.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: György Kovács
+ *
+ *      String arena, fixed blocks of the returned strings (0x70), borrowed by the tasks
+ */
+
+#include "Nextion_HMI.h"
+
+/**
+ * @brief Free every block of the string arena
+ * @note  Called from NxHmi_Init()
+ *
+ * @param void
+ * @retval void
+ */
+void stringInit(void) {
+	nextionHMI_h.stringFree = (NEX_STRING_BLOCKS >= 32) ? 0xFFFFFFFFUL : ((1UL << NEX_STRING_BLOCKS) - 1UL);
+	nextionHMI_h.stringDropCnt = 0;
+}
+
+/**
+ * @brief Take a free block of the string arena
+ * @note  Called by the protocol parser at the head of a string frame
+ *
+ * @param void
+ * @retval block of NEX_STRING_BLOCK_SIZE bytes, NULL if every block is borrowed
+ */
+char *stringAlloc(void) {
+	char *pBlock = NULL;
+
+	taskENTER_CRITICAL();
+	for(uint8_t i = 0; i < NEX_STRING_BLOCKS; i++) {
+		if(nextionHMI_h.stringFree & (1UL << i)) {
+			nextionHMI_h.stringFree &= ~(1UL << i);
+			pBlock = nextionHMI_h.stringArena[i];
+			break;
+		}
+	}//end for loop
+	taskEXIT_CRITICAL();
+
+	return pBlock;
+}
+
+/**
+ * @brief Give back a string returned by the display
+ * @note  Call it when the string is not needed any more, e.g. after NxHmi_GetObjText()
+ *
+ * @param *pText = returned string, can be NULL
+ * @retval void
+ */
+void NxHmi_ReleaseText(const char *pText) {
+	uint32_t offset;
+
+	if(pText == NULL) {
+		return;
+	}
+	offset = (uint32_t)((uintptr_t)pText - (uintptr_t)nextionHMI_h.stringArena);
+	if( (offset >= sizeof(nextionHMI_h.stringArena)) || (offset % NEX_STRING_BLOCK_SIZE) ) {
+		//Not a block of the arena
+		return;
+	}
+
+	taskENTER_CRITICAL();
+	nextionHMI_h.stringFree |= (1UL << (offset / NEX_STRING_BLOCK_SIZE));
+	taskEXIT_CRITICAL();
+}
@@ -9,12 +9,22 @@
 
 #include "Nextion_HMI.h"
 
+//Baud rates of the display, in ascending order
+static const uint32_t comSpeedRates[] = {
+	9600, 19200, 38400, 57600, 115200, 230400, 250000, 256000, 512000, 921600
+};
 
+//PRIVATE FUNCTION PROTOTYPES//
+static Ret_Status_t comSpeedSwitch(uint32_t baud, Cnf_permanence_t cnfSave);
+static Ret_Status_t comSpeedProbe(void);
 
 
 /**
  * @brief Set the display verbose level
- * @note  Without calling this function, 2 is the default level.
+ * @note  NxHmi_ResetDevice() sets NEX_BKCMD_DEFAULT (3).
+ * 		  Below level 3 a failure answer carries no reference to its command. The TX engine
+ * 		  sends one answer-expecting command per burst then, but an error which arrives after
+ * 		  the quiet time of its burst is still matched to a command of the next burst.
  * @levels	0 - Off, no feedback
  * 			1 - OnSuccess, return data only if the last serial command was executed successfully
  * 			2 - OnFailure, return data only if the execution of the last serial command failed
@@ -27,10 +37,10 @@ void NxHmi_Verbosity(uint8_t vLevel) {
 
 	if(vLevel > 3) vLevel = 3;
 
-	prepareToSend(0);
-	sprintf(txBuf, "bkcmd=%i", vLevel);
-	HmiSendCommand(txBuf);
-	waitForAnswer(NULL);
+	Nextion_TxBuffer_t *pTxBuff = prepareToSend(0);
+	encodeCommand(pTxBuff, "bkcmd=", 1, vLevel);
+	//Sent with the previous level, its answer is matched either way
+	HmiSendAndWait(pTxBuff, EXPECT_ACK, NULL);
 	nextionHMI_h.ifaceVerbose = vLevel;
 }
 
@@ -41,41 +51,65 @@ void NxHmi_Verbosity(uint8_t vLevel) {
  * @param value   = Brightness value in %, 0-100%
  * @param cnfSave = SET_TEMPORARY = after reset goes back to default brightness
  *                  SET_PERMANENT = save the value as default
- * @retval see @ref waitForAnswer() function for return value
+ * @retval see @ref HmiSendAndWait() function for return value
  */
 Ret_Status_t NxHmi_SetBacklight( uint8_t value, Cnf_permanence_t cnfSave) {
 
-	prepareToSend(0);
+	Nextion_TxBuffer_t *pTxBuff = prepareToSend(0);
 	if(value > 100) value = 100;
 
 	if (cnfSave == SET_PERMANENT) {
-		sprintf(txBuf, "dims=%i", value);
+		encodeCommand(pTxBuff, "dims=", 1, value);
 	} else {
-		sprintf(txBuf, "dim=%i", value);
+		encodeCommand(pTxBuff, "dim=", 1, value);
+	}
+	return HmiSendAndWait(pTxBuff, EXPECT_ACK, NULL);
+}
+
+/**
+ * @brief Set Nextion display backlight brightness, without waiting
+ * @note  Async version of NxHmi_SetBacklight()
+ *
+ * @param value   = Brightness value in %, 0-100%
+ * @param cnfSave = SET_TEMPORARY = after reset goes back to default brightness
+ *                  SET_PERMANENT = save the value as default
+ * @param *pToken = completion token, NULL if not required
+ * @retval see @ref NxHmi_SetTextAsync() function for return value
+ */
+Ret_Status_t NxHmi_SetBacklightAsync(uint8_t value, Cnf_permanence_t cnfSave, Nextion_Token_t *pToken) {
+
+	Nextion_TxBuffer_t *pTxBuff;
+
+	if(prepareToQueue(&pTxBuff, pToken) != STAT_OK) {
+		return STAT_ERROR;
+	}
+	if(value > 100) value = 100;
+
+	if (cnfSave == SET_PERMANENT) {
+		encodeCommand(pTxBuff, "dims=", 1, value);
+	} else {
+		encodeCommand(pTxBuff, "dim=", 1, value);
 	}
-	HmiSendCommand(txBuf);
 
-	return waitForAnswer(NULL);
+	return HmiQueueBuffer(pTxBuff, pToken);
 }
 
 /**
  * @brief Start sending real time touch coordinates
- * @note  Receiving procedure must to be implemented in the user code
+ * @note  Read the positions with NxHmi_TouchLast() or NxHmi_TouchRead()
  *
  * @param status = 0 - stop sending, 1 - start sending
- * @retval see @ref waitForAnswer() function for return value
+ * @retval see @ref HmiSendAndWait() function for return value
  */
 Ret_Status_t NxHmi_SendXYcoordinates(uint8_t status) {
 
-	prepareToSend(0);
+	Nextion_TxBuffer_t *pTxBuff = prepareToSend(0);
 	if (status) {
 		status = 1;
 	}
 
-	sprintf(txBuf, "sendxy=%i", status);
-	HmiSendCommand(txBuf);
-
-	return waitForAnswer(NULL);
+	encodeCommand(pTxBuff, "sendxy=", 1, status);
+	return HmiSendAndWait(pTxBuff, EXPECT_ACK, NULL);
 }
 
 /**
@@ -83,32 +117,32 @@ Ret_Status_t NxHmi_SendXYcoordinates(uint8_t status) {
  * @note
  *
  * @param status = 0 - exit from sleep mode, 1 - enter to sleep mode
- * @retval see @ref waitForAnswer() function for return value
+ * @retval see @ref HmiSendAndWait() function for return value
  */
 Ret_Status_t NxHmi_Sleep(uint8_t status) {
 
-	prepareToSend(0);
+	Nextion_TxBuffer_t *pTxBuff = prepareToSend(0);
 	if (status) {
 		status = 1;
 	}
-	sprintf(txBuf, "sleep=%i", status);
-	HmiSendCommand(txBuf);
-
-	return waitForAnswer(NULL);
+	encodeCommand(pTxBuff, "sleep=", 1, status);
+	return HmiSendAndWait(pTxBuff, EXPECT_ACK, NULL);
 }
 
 /**
  * @brief Configure display auto sleep/wake up events
- * @note
+ * @note  With a verified MACRO_OP_AUTOSLEEP macro the values are set by its script, in one burst.
+ * 		  Otherwise four commands are sent, each waits for its answer.
  *
  * @param slNoSer 	- No serial then sleep timer in seconds (3 - 65535), default: 0 - turned off
  * @param slNoTouch - No touch then sleep timer in seconds (3 - 65535), default: 0 - turned off
  * @param wkpSer	- Wake up if serial data arrives, 0 - off (don't wake up), 1 - on
  * @param wkpTouch	- Wake up if touch event occurs, 0 - off (don't wake up), 1 - on
- * @retval see @ref waitForAnswer() function for return value
+ * @retval see @ref HmiSendAndWait() function for return value
  */
 Ret_Status_t NxHmi_SetAutoSleep(uint16_t slNoSer, uint16_t slNoTouch, uint8_t wkpSer, uint8_t wkpTouch) {
 	Ret_Status_t tmpRet;
+	Nextion_Macro_t *pMacro;
 
 	//limiting values
 	if( (slNoSer > 0) && (slNoSer < 3) ) slNoSer = 3; //min. 3 second or 0 - disabled
@@ -116,94 +150,205 @@ Ret_Status_t NxHmi_SetAutoSleep(uint16_t slNoSer, uint16_t slNoTouch, uint8_t wk
 	if( wkpSer ) wkpSer = 1;
 	if( wkpTouch ) wkpTouch = 1;
 
+	pMacro = macroFind(MACRO_OP_AUTOSLEEP);
+	if(pMacro != NULL) {
+		//ussp=sys0&65535, thsp=sys0>>16&65535, usup=sys1&1, thup=sys1>>1 (evaluated left to right)
+		int32_t args[2] = { (int32_t)( (uint32_t)slNoSer | ((uint32_t)slNoTouch << 16) ), wkpSer | (wkpTouch << 1) };
+		return NxHmi_MacroRun(pMacro, 2, args);
+	}
+
 	//Enable/disable wake up on serial event
-	prepareToSend(0);
-	sprintf(txBuf, "usup=%i", wkpSer);
-	HmiSendCommand(txBuf);
-	tmpRet = waitForAnswer(NULL);
+	Nextion_TxBuffer_t *pTxBuff = prepareToSend(0);
+	encodeCommand(pTxBuff, "usup=", 1, wkpSer);
+	tmpRet = HmiSendAndWait(pTxBuff, EXPECT_ACK, NULL);
 
 	//Enable/disable wake up on touch event
 	if(tmpRet == STAT_OK) {
-		prepareToSend(0);
-		sprintf(txBuf, "thup=%i", wkpTouch);
-		HmiSendCommand(txBuf);
-		tmpRet = waitForAnswer(NULL);
+		pTxBuff = prepareToSend(0);
+		encodeCommand(pTxBuff, "thup=", 1, wkpTouch);
+		tmpRet = HmiSendAndWait(pTxBuff, EXPECT_ACK, NULL);
 	} else {
 		return tmpRet;
 	}
 
 	//Set no serial timer
 	if(tmpRet == STAT_OK) {
-		prepareToSend(0);
-		sprintf(txBuf, "ussp=%u", slNoSer);
-		HmiSendCommand(txBuf);
-		tmpRet = waitForAnswer(NULL);
+		pTxBuff = prepareToSend(0);
+		encodeCommand(pTxBuff, "ussp=", 1, slNoSer);
+		tmpRet = HmiSendAndWait(pTxBuff, EXPECT_ACK, NULL);
 	} else {
 		return tmpRet;
 	}
 
 	//Set no touch timer
 	if(tmpRet == STAT_OK) {
-		prepareToSend(0);
-		sprintf(txBuf, "thsp=%u", slNoTouch);
-		HmiSendCommand(txBuf);
-		tmpRet = waitForAnswer(NULL);
+		pTxBuff = prepareToSend(0);
+		encodeCommand(pTxBuff, "thsp=", 1, slNoTouch);
+		tmpRet = HmiSendAndWait(pTxBuff, EXPECT_ACK, NULL);
 	}
 	return tmpRet;
 }
 
 /**
  * @brief Configure the display communications speed
- * @note  TODO: proper way to change the UART speed on the fly under RTOS
+ * @note  Sends baud= (or bauds=) at the current rate, then the UART follows the display.
+ * 		  The link is verified with NEX_BAUD_PROBE_COUNT probe commands, if any of them fails
+ * 		  both sides go back to the previous rate. The waiting commands are held meanwhile.
  *
  * @param baud = The new desired speed value
  * @param cnfSave = SET_TEMPORARY = after reset goes back to default speed
  *                  SET_PERMANENT = save the value as default
- * @retval void
+ * @retval 	STAT_TIMEOUT	= the commands in flight are not answered, nothing is changed
+ * 			STAT_FAILED		= the link is not stable at the new rate, it's back at the previous one
+ * 			STAT_ERROR		= the link is lost
+ * 			STAT_OK 		= the new rate is in use
  */
+Ret_Status_t NxHmi_ComSpeed(uint32_t baud, Cnf_permanence_t cnfSave) {
+	uint32_t baudPrev = nextionHMI_h.pUart->Init.BaudRate;
+	Ret_Status_t tmpRet;
 
-/*
-void NxHmi_ComSpeed(uint32_t baud, Cnf_permanence_t cnfSave) {
-
-	prepareToSend();
-	if (cnfSave) {
-		sprintf(txBuf, "bauds=%i", (int)baud);
-	} else {
-		sprintf(txBuf, "baud=%i", (int)baud);
+	tmpRet = comSpeedSwitch(baud, cnfSave);
+	if(tmpRet != STAT_OK) {
+		return tmpRet;
+	}
+	if(comSpeedProbe() == STAT_OK) {
+		if(cnfSave == SET_PERMANENT) {
+			nextionHMI_h.baudDefault = baud;
+		}
+		return STAT_OK;
 	}
 
-	NxHmi_Send_Command( txBuf);
-
-	HAL_UART_AbortReceive_IT(nextionHMI_h.pUart);
-
+	//Fall back, the display may understand the command at the new rate
+	nextionHMI_h.errorCnt++;
+	if(comSpeedSwitch(baudPrev, cnfSave) != STAT_OK) {
+		return STAT_ERROR;
+	}
+	if(comSpeedProbe() != STAT_OK) {
+		return STAT_ERROR;
+	}
+	return STAT_FAILED;
+}
 
-    //osDelay(100);
-    while (HAL_UART_GetState(nextionHMI_h.pUart) == HAL_UART_STATE_BUSY) {
-    	osDelay(1);
-    }
+/**
+ * @brief Step up the communications speed to the highest stable rate
+ * @note  Tries the standard rates above the current one, up to maxBaud,
+ * 		  and stops at the first one which fails. e.g. 9600 -> 921600 is ~100x throughput.
+ * 		  Call it after NxHmi_ResetDevice(), the reset goes back to the default rate.
+ *
+ * @param maxBaud = highest rate to try, e.g. NEX_BAUD_MAX
+ * @param cnfSave = SET_TEMPORARY = after reset goes back to default speed
+ *                  SET_PERMANENT = save the reached rate as default
+ * @retval 	STAT_ERROR		= the link is lost
+ * 			STAT_OK 		= the highest stable rate is in use, see the UART handler for its value
+ */
+Ret_Status_t NxHmi_ComSpeedMax(uint32_t maxBaud, Cnf_permanence_t cnfSave) {
+	Ret_Status_t tmpRet = STAT_OK;
+
+	for(uint8_t i = 0; i < (sizeof(comSpeedRates) / sizeof(comSpeedRates[0])); i++) {
+		if(comSpeedRates[i] > maxBaud) {
+			break;
+		}
+		if(comSpeedRates[i] <= nextionHMI_h.pUart->Init.BaudRate) {
+			continue;
+		}
+		tmpRet = NxHmi_ComSpeed(comSpeedRates[i], SET_TEMPORARY);
+		if(tmpRet != STAT_OK) {
+			break;
+		}
+	}//end for loop
+
+	if(tmpRet == STAT_ERROR) {
+		return STAT_ERROR;
+	}
+	if( (cnfSave == SET_PERMANENT) && (nextionHMI_h.baudDefault != nextionHMI_h.pUart->Init.BaudRate) ) {
+		//Save the reached rate, it's already verified
+		return NxHmi_ComSpeed(nextionHMI_h.pUart->Init.BaudRate, SET_PERMANENT);
+	}
+	return STAT_OK;
+}
 
-    taskENTER_CRITICAL();
-	//nextionHMI_h.pUart->Instance->CR1 &= ~(USART_CR1_UE);     //Disable USART
-	//nextionHMI_h.pUart->Instance->BRR = UART_BRR_SAMPLING8(HAL_RCC_GetPCLK2Freq(), baud);
-	//nextionHMI_h.pUart->Instance->CR1 |= (USART_CR1_UE);     //Enable USART
-    HAL_UART_DeInit(nextionHMI_h.pUart);
-    nextionHMI_h.pUart->Init.BaudRate = baud;
-    if (HAL_UART_Init(nextionHMI_h.pUart) != HAL_OK) {
-      Error_Handler();
-    }
+/**
+ * @brief Reconfigure the UART to a new baud rate
+ * @note  The line must be idle. The RX ring is dropped, the DMA reception is restarted
+ * 		  by the RX task, the parser state is not touched from the calling task.
+ * 		  The TX timer period is set by the pacing after every burst.
+ *
+ * @param baud = new baud rate
+ * @retval void
+ */
+void comSpeedUart(uint32_t baud) {
+	uint8_t startCnt = nextionHMI_h.rxStartCnt;
+
+	HAL_UART_AbortReceive(nextionHMI_h.pUart);
+	HAL_UART_DeInit(nextionHMI_h.pUart);
+	nextionHMI_h.pUart->Init.BaudRate = baud;
+	if(HAL_UART_Init(nextionHMI_h.pUart) != HAL_OK) {
+		Error_Handler();
+	}
 
+	//The half received frames are lost, wait until the RX task has restarted the reception
+	nextionHMI_h.rxRestart = 1;
+	xTaskNotifyGive((TaskHandle_t)hmiRxTaskHandle);
+	while(nextionHMI_h.rxStartCnt == startCnt) {
+		vTaskDelay(1);
+	}
+}
 
-    while (HAL_UART_GetState(nextionHMI_h.pUart) != HAL_UART_STATE_READY) {
+//////////////////////////STATIC FUNCTIONS////////////////////////////
 
-    }
-    nextionHMI_h.rxCounter = 0;
-    HAL_UART_Receive_IT(nextionHMI_h.pUart, &nextionHMI_h.rxBuff[0], 1);
-    taskEXIT_CRITICAL();
-    if( xTimerIsTimerActive( nextionHMI_h.rxTimerHandle ) != pdFALSE ) {
-    	xTimerDelete(nextionHMI_h.rxTimerHandle,0);
-    }
-	xTimerChangePeriod(nextionHMI_h.rxTimerHandle, TOUT_PERIOD_CALC(baud), 10);
+/**
+ * @brief Send baud= and follow the display to the new rate
+ * @note  The line is locked, the command is sent in blocking mode. Its answer is not waited,
+ * 		  it may arrive at either rate.
+ *
+ * @param baud = new baud rate
+ * @param cnfSave = baud= or bauds=
+ * @retval 	STAT_TIMEOUT	= the line could not be locked
+ * 			STAT_ERROR		= transmission failed
+ * 			STAT_OK 		= both sides are at the new rate
+ */
+static Ret_Status_t comSpeedSwitch(uint32_t baud, Cnf_permanence_t cnfSave) {
+	Nextion_TxBuffer_t txBuff;
+	HAL_StatusTypeDef halStatus;
+
+	encodeLocal(&txBuff);
+	encodeText(&txBuff, (cnfSave == SET_PERMANENT) ? "bauds=" : "baud=");
+	encodeInt(&txBuff, (int32_t)baud);
+	encodeEnd(&txBuff);
+
+	//the display is started but not reseted yet
+	while(nextionHMI_h.hmiStatus == COMP_INVALID) {
+		vTaskDelay(pdMS_TO_TICKS(5));
+	}
+	if(txEngineLock(NEX_ANSW_TIMEOUT) != STAT_OK) {
+		return STAT_TIMEOUT;
+	}
+	halStatus = HAL_UART_Transmit(nextionHMI_h.pUart, txBuff.data, txBuff.length, NEX_ANSW_TIMEOUT);
+	if(halStatus == HAL_OK) {
+		comSpeedUart(baud);
+		vTaskDelay(pdMS_TO_TICKS(NEX_BAUD_SETTLE_TIME));
+		//Drop the answer of baud=
+		xQueueReset(nextionHMI_h.rxCommandQHandle);
+	}
+	txEngineUnlock();
 
+	return (halStatus == HAL_OK) ? STAT_OK : STAT_ERROR;
+}
 
-}*/
+/**
+ * @brief Verify the link at the current rate
+ * @note  sendme is answered at every bkcmd level
+ *
+ * @param void
+ * @retval 	STAT_OK 	= every probe is answered
+ * 			other		= see NxHmi_GetCurrentPageId()
+ */
+static Ret_Status_t comSpeedProbe(void) {
+	Ret_Status_t tmpRet = STAT_OK;
+	uint8_t pageId;
 
+	for(uint8_t i = 0; (i < NEX_BAUD_PROBE_COUNT) && (tmpRet == STAT_OK); i++) {
+		tmpRet = NxHmi_GetCurrentPageId(&pageId);
+	}//end for loop
+	return tmpRet;
+}
@@ -0,0 +1,209 @@
+/*
+ * Nextion_HMI_Text.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: György Kovács
+ *
+ *      Long texts, streamed from the buffer of the caller or sent in += chunks
+ */
+
+#include "Nextion_HMI.h"
+
+//PRIVATE FUNCTION PROTOTYPES//
+static Ret_Status_t textStream(Nextion_Object_t *pOb_handle, const char *text, uint16_t length, uint16_t cmdLength);
+static Ret_Status_t textChunks(Nextion_Object_t *pOb_handle, const char *text, uint16_t length);
+static uint16_t textEscapeCount(const char *text, uint16_t length);
+
+/**
+ * @brief Set a long text of a Nextion object, e.g. a log view
+ * @note  Quotes and backslashes are escaped. Unlike NxHmi_SetText(), the length is not limited
+ * 		  by the TX staging buffers (txt_maxl of the component must be large enough).
+ * 		  Up to NEX_TEXT_STREAM_MAX bytes the command is streamed from the buffer of the caller,
+ * 		  without copying it, the line is locked for its wire time. A longer text is sent
+ * 		  in "+=" chunks, which are pipelined with the commands of the other tasks.
+ *
+ * @param *pOb_handle = Nextion object handler
+ * @param *text = string pointer
+ * @retval see @ref HmiSendAndWait() function for return value
+ */
+Ret_Status_t NxHmi_SetLongText(Nextion_Object_t *pOb_handle, const char *text) {
+	uint32_t textHash = shadowHashText(text);
+	uint32_t length;
+	uint32_t cmdLength;
+	Ret_Status_t retStatus;
+
+	if(shadowIsCached(pOb_handle, SHADOW_TXT, textHash)) {
+		return STAT_OK;
+	}
+	length = strlen(text);
+	if(length > UINT16_MAX) {
+		return STAT_ERROR;
+	}
+	//name.txt="<escaped text>" and the terminator
+	cmdLength = encodeNameLength(pOb_handle) + 6U + length + textEscapeCount(text, (uint16_t)length) + 1U + 3U;
+
+	if(cmdLength <= NEX_TEXT_STREAM_MAX) {
+		retStatus = textStream(pOb_handle, text, (uint16_t)length, (uint16_t)cmdLength);
+	} else {
+		retStatus = textChunks(pOb_handle, text, (uint16_t)length);
+	}
+
+	return shadowUpdate(pOb_handle, SHADOW_TXT, textHash, retStatus);
+}
+
+//////////////////////////STATIC FUNCTIONS////////////////////////////
+
+/**
+ * @brief Stream the text command in segments: prefix, runs of the text, suffix and terminator
+ * @note  The runs are split at the escaped characters, the escape goes in its own segment
+ *
+ * @param *pOb_handle = Nextion object handler
+ * @param *text = string pointer
+ * @param length = number of characters
+ * @param cmdLength = length of the escaped command, with the terminator
+ * @retval see @ref HmiSendAndWait() function for return value
+ */
+static Ret_Status_t textStream(Nextion_Object_t *pOb_handle, const char *text, uint16_t length, uint16_t cmdLength) {
+	static const uint8_t suffix[4] = { '"', 0xFF, 0xFF, 0xFF };
+	Nextion_Token_t token;
+	Ret_Status_t retStatus;
+	Ret_Status_t tmpRet;
+	const char *pRun = text;
+	uint32_t cost = admitCost(cmdLength, PACE_SET);
+
+	//the display is started but not reseted yet
+	while(nextionHMI_h.hmiStatus == COMP_INVALID) {
+		vTaskDelay(pdMS_TO_TICKS(5));
+	}
+	admitWait(txEngineLane());
+	if(admitCharge(txEngineLane(), cost, 1) != STAT_OK) {
+		return STAT_BUSY;
+	}
+
+	NxHmi_TokenInit(&token, NULL, NULL);
+	if(txEngineStreamBegin(cmdLength, &token) != STAT_OK) {
+		//Not sent, it doesn't use the budget
+		admitRefund(txEngineLane(), cost);
+		return STAT_TIMEOUT;
+	}
+
+	retStatus = txEngineStreamWrite((const uint8_t*)pOb_handle->Name, pOb_handle->NameLength);
+	if(retStatus == STAT_OK) {
+		retStatus = txEngineStreamWrite((const uint8_t*)".txt=\"", 6);
+	}
+	for(uint16_t i = 0; (i < length) && (retStatus == STAT_OK); i++) {
+		if( (text[i] == '"') || (text[i] == '\\') ) {
+			retStatus = txEngineStreamWrite((const uint8_t*)pRun, &text[i] - pRun);
+			if(retStatus == STAT_OK) {
+				retStatus = txEngineStreamWrite((const uint8_t*)"\\", 1);
+			}
+			pRun = &text[i];
+		}
+	}//end for loop
+	if(retStatus == STAT_OK) {
+		retStatus = txEngineStreamWrite((const uint8_t*)pRun, &text[length] - pRun);
+	}
+	if(retStatus == STAT_OK) {
+		retStatus = txEngineStreamWrite(suffix, sizeof(suffix));
+	}
+	txEngineStreamEnd(retStatus);
+
+	//The token is in the expectation list, wait for it either way
+	tmpRet = NxHmi_TokenWait(&token, portMAX_DELAY);
+	return (retStatus == STAT_OK) ? tmpRet : retStatus;
+}
+
+/**
+ * @brief Send the text in chunks, name.txt="<first>" then name.txt+="<next>"
+ * @note  Every chunk fits into the chained staging buffers of one command.
+ * 		  Two chunks are in flight, a chunk is queued when the answer of the one before
+ * 		  the previous has arrived. It stops at the first failed chunk, a partial text
+ * 		  is not continued.
+ *
+ * @param *pOb_handle = Nextion object handler
+ * @param *text = string pointer
+ * @param length = number of characters, not 0
+ * @retval see @ref HmiSendAndWait() function for return value, the first failure of the chunks
+ */
+static Ret_Status_t textChunks(Nextion_Object_t *pOb_handle, const char *text, uint16_t length) {
+	//Room of the escaped text, after name.txt+=" and before the closing quote
+	uint16_t room = (NEX_TX_CHAIN_MAX * (NEX_TX_BUFF_SIZE - 3)) - encodeNameLength(pOb_handle) - 8U;
+	Nextion_TxBuffer_t *pTxBuff;
+	Nextion_Token_t tokens[2];
+	uint8_t pending[2] = { 0, 0 };
+	Ret_Status_t retStatus = STAT_OK;
+	Ret_Status_t tmpRet;
+	uint16_t chunk;
+	uint16_t used;
+	uint16_t n = 0;
+
+	NxHmi_TokenInit(&tokens[0], NULL, NULL);
+	NxHmi_TokenInit(&tokens[1], NULL, NULL);
+	while(length > 0) {
+		//Take the characters while their escaped form fits
+		chunk = used = 0;
+		while(chunk < length) {
+			used += ( (text[chunk] == '"') || (text[chunk] == '\\') ) ? 2U : 1U;
+			if(used > room) {
+				break;
+			}
+			chunk++;
+		}//end while loop
+
+		if(pending[n & 1]) {
+			//The token of the chunk before the previous one is reused
+			pending[n & 1] = 0;
+			retStatus = NxHmi_TokenWait(&tokens[n & 1], portMAX_DELAY);
+			if(retStatus != STAT_OK) {
+				break;
+			}
+		}
+
+		pTxBuff = prepareToSend(0);
+		encodeText(pTxBuff, pOb_handle->Name);
+		encodeText(pTxBuff, (n == 0) ? ".txt=\"" : ".txt+=\"");
+		encodeTextEscaped(pTxBuff, text, chunk);
+		encodeChar(pTxBuff, '"');
+
+		text += chunk;
+		length -= chunk;
+		//The token is completed even if the chunk is not queued
+		pending[n & 1] = 1;
+		tmpRet = HmiQueueBufferWait(pTxBuff, &tokens[n & 1]);
+		n++;
+		if(tmpRet != STAT_OK) {
+			break;
+		}
+	}//end while loop
+
+	//The chunks in flight, the older one first
+	for(uint8_t i = 0; i < 2; i++) {
+		if(pending[(n + i) & 1]) {
+			tmpRet = NxHmi_TokenWait(&tokens[(n + i) & 1], portMAX_DELAY);
+			if(retStatus == STAT_OK) {
+				retStatus = tmpRet;
+			}
+		}
+	}//end for loop
+
+	return retStatus;
+}
+
+/**
+ * @brief Number of characters to escape
+ * @note  Quotes and backslashes
+ *
+ * @param *text = string pointer
+ * @param length = number of characters
+ * @retval number of escapes
+ */
+static uint16_t textEscapeCount(const char *text, uint16_t length) {
+	uint16_t count = 0;
+
+	for(uint16_t i = 0; i < length; i++) {
+		if( (text[i] == '"') || (text[i] == '\\') ) {
+			count++;
+		}
+	}//end for loop
+	return count;
+}
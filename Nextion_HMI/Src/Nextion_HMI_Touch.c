@@ -0,0 +1,155 @@
+/*
+ * Nextion_HMI_Touch.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: György Kovács
+ *
+ *      Touch stream, last position register and history of the touch coordinates (0x67, 0x68)
+ */
+
+#include "Nextion_HMI.h"
+
+/**
+ * @brief Clear the touch stream
+ * @note  Called from NxHmi_Init()
+ *
+ * @param void
+ * @retval void
+ */
+void touchInit(void) {
+	nextionHMI_h.touchSeq = 0;
+	nextionHMI_h.touchHead = 0;
+	memset(&nextionHMI_h.touchLast, 0x00, sizeof(Nextion_Touch_t));
+#if (NEX_TOUCH_HISTORY > 0)
+	nextionHMI_h.touchTail = 0;
+	nextionHMI_h.touchDropCnt = 0;
+#endif
+}
+
+/**
+ * @brief Store a received touch position
+ * @note  Called from validateCommand() by the RX task, the only writer.
+ * 		  The coordinates are sent in big endian order: head, x, y, event.
+ * 		  The last position is a seqlock, the sequence is odd while it's written.
+ * 		  The history slot is written before the head is moved.
+ *
+ * @param *cmdBuff = 0x67 or 0x68 frame, without the terminator
+ * @retval void
+ */
+void touchPush(const uint8_t *cmdBuff) {
+	Nextion_Touch_t touch;
+
+	touch.number = nextionHMI_h.touchHead + 1U;
+	touch.xTimeReceived = xTaskGetTickCount();
+	touch.xCoordinate = (cmdBuff[1] << 8) | (cmdBuff[2] << 0);
+	touch.yCoordinate = (cmdBuff[3] << 8) | (cmdBuff[4] << 0);
+	touch.event = cmdBuff[5];
+	touch.sleep = (cmdBuff[0] == NEX_EVENT_SLEEP_POSITION_HEAD);
+
+	nextionHMI_h.touchSeq++;
+	__DMB();
+	nextionHMI_h.touchLast = touch;
+	__DMB();
+	nextionHMI_h.touchSeq++;
+
+#if (NEX_TOUCH_HISTORY > 0)
+	nextionHMI_h.touchHistory[nextionHMI_h.touchHead & TOUCH_RING_MASK] = touch;
+	__DMB();
+#endif
+	nextionHMI_h.touchHead++;
+}
+
+/**
+ * @brief Read the last touch position
+ * @note  Doesn't block, can be called from any task or ISR. The positions in between
+ * 		  are coalesced, compare the number with the previous one to see a new position.
+ * 		  Send the coordinates with NxHmi_SendXYcoordinates(1).
+ *
+ * @param *pTouch = returned position
+ * @retval 	STAT_BUSY	= the RX task is writing it (it has been preempted), try again later
+ * 			STAT_FAILED	= no position received yet
+ * 			STAT_OK 	= position returned
+ */
+Ret_Status_t NxHmi_TouchLast(Nextion_Touch_t *pTouch) {
+	uint32_t seq;
+
+	//Don't spin, the writer can't run while a higher priority reader waits for it
+	for(uint8_t i = 0; i < 2; i++) {
+		seq = nextionHMI_h.touchSeq;
+		__DMB();
+		*pTouch = nextionHMI_h.touchLast;
+		__DMB();
+		if( ((seq & 1U) == 0) && (seq == nextionHMI_h.touchSeq) ) {
+			return (pTouch->number > 0) ? STAT_OK : STAT_FAILED;
+		}
+	}//end for loop
+
+	return STAT_BUSY;
+}
+
+/**
+ * @brief Read the oldest position of the touch history, e.g. the path of a drag
+ * @note  Doesn't block, one reader task only. If the reader falls behind,
+ * 		  the oldest positions are overwritten, see NxHmi_GetTouchDropCount().
+ *
+ * @param *pTouch = returned position
+ * @retval 	STAT_ERROR	= no history, NEX_TOUCH_HISTORY is 0
+ * 			STAT_FAILED	= no new position
+ * 			STAT_OK 	= position returned
+ */
+Ret_Status_t NxHmi_TouchRead(Nextion_Touch_t *pTouch) {
+#if (NEX_TOUCH_HISTORY > 0)
+	uint32_t head;
+
+	while(1) {
+		head = nextionHMI_h.touchHead;
+		__DMB();
+		if(head == nextionHMI_h.touchTail) {
+			return STAT_FAILED;
+		}
+		if( (head - nextionHMI_h.touchTail) >= NEX_TOUCH_HISTORY ) {
+			//Keep the newest ones, the slot of the next position may be under writing
+			nextionHMI_h.touchDropCnt += (head - nextionHMI_h.touchTail) - (NEX_TOUCH_HISTORY - 1U);
+			nextionHMI_h.touchTail = head - (NEX_TOUCH_HISTORY - 1U);
+		}
+
+		*pTouch = nextionHMI_h.touchHistory[nextionHMI_h.touchTail & TOUCH_RING_MASK];
+		__DMB();
+		if( (nextionHMI_h.touchHead - nextionHMI_h.touchTail) < NEX_TOUCH_HISTORY ) {
+			//Not overwritten while it was copied
+			nextionHMI_h.touchTail++;
+			return STAT_OK;
+		}
+	}//end while loop
+#else
+	return STAT_ERROR;
+#endif
+}
+
+/**
+ * @brief Drop the positions of the touch history
+ * @note  E.g. at the start of a new drag, called by the reader of the history
+ *
+ * @param void
+ * @retval void
+ */
+void NxHmi_TouchFlush(void) {
+#if (NEX_TOUCH_HISTORY > 0)
+	nextionHMI_h.touchTail = nextionHMI_h.touchHead;
+#endif
+}
+
+/**
+ * @brief Number of positions overwritten in the touch history before reading
+ * @note  The last position is always available with NxHmi_TouchLast()
+ *
+ * @param void
+ * @retval Number of dropped positions since NxHmi_Init()
+ */
+uint32_t NxHmi_GetTouchDropCount(void) {
+#if (NEX_TOUCH_HISTORY > 0)
+	return nextionHMI_h.touchDropCnt;
+#else
+	return 0;
+#endif
+}
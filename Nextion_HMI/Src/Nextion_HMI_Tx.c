@@ -0,0 +1,804 @@
+/*
+ * Nextion_HMI_Tx.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: György Kovács
+ *
+ *      TX engine, staging buffers, command coalescing and DMA/IT transmission
+ *      Completion tokens of the async commands
+ */
+
+#include "Nextion_HMI.h"
+
+const osMessageQueueAttr_t txFreeQ_attributes = {
+  .name = "txFreeQ"
+};
+
+const osMessageQueueAttr_t txReadyQ_attributes[LANE_COUNT] = {
+  { .name = "txReadyQ0" },
+  { .name = "txReadyQ1" },
+  { .name = "txReadyQ2" }
+};
+
+//PRIVATE FUNCTION PROTOTYPES//
+static uint8_t txEngineCollect(void);
+static uint8_t txEngineCollectLane(Nextion_Lane_t *pLane, uint16_t maxLength);
+static uint8_t txEngineWaiting(void);
+static HAL_StatusTypeDef txEngineStart(void);
+static void txEngineRelease(void);
+static void txEnginePendedKick(void *pvParameter1, uint32_t ulParameter2);
+
+/**
+ * @brief Create the TX buffer pool and the queue of the outgoing commands
+ * @note  Called from NxHmi_Init(), BEFORE osKernelStart()
+ *
+ * @param void
+ * @retval void
+ */
+void txEngineInit(void) {
+	Nextion_TxBuffer_t *pTxBuff;
+
+	nextionHMI_h.txBurstCount = 0;
+	nextionHMI_h.txBurstCmdCount = 0;
+	nextionHMI_h.txBurstLength = 0;
+	nextionHMI_h.txLineBusy = 0;
+	nextionHMI_h.txByteCnt = 0;
+	nextionHMI_h.txBurstCnt = 0;
+	nextionHMI_h.txBurstExpectCount = 0;
+	nextionHMI_h.txHoldLine = 0;
+	nextionHMI_h.txTransparent = 0;
+
+	nextionHMI_h.txFreeQHandle = osMessageQueueNew (NEX_TX_BUFF_COUNT, sizeof(Nextion_TxBuffer_t*), &txFreeQ_attributes);
+	for(uint8_t i = 0; i < LANE_COUNT; i++) {
+		memset(&nextionHMI_h.txLanes[i], 0x00, sizeof(Nextion_Lane_t));
+		nextionHMI_h.txLanes[i].readyQHandle = osMessageQueueNew (NEX_TX_BUFF_COUNT, sizeof(Nextion_TxBuffer_t*), &txReadyQ_attributes[i]);
+	}//end for loop
+
+	for(uint8_t i = 0; i < NEX_TX_BUFF_COUNT; i++) {
+		pTxBuff = &nextionHMI_h.txBuffers[i];
+		pTxBuff->length = 0;
+		pTxBuff->xTaskToNotify = NULL;
+		pTxBuff->pToken = NULL;
+		xQueueSend(nextionHMI_h.txFreeQHandle, &pTxBuff, 0);
+	}//end for loop
+
+#if NEX_TX_GATHER_TIME > 0
+	nextionHMI_h.txGatherTimer = xTimerCreate("TxGather",
+									pdMS_TO_TICKS(NEX_TX_GATHER_TIME), // Collecting window of a burst
+									pdFALSE,         // One-shot timer
+									( void * )0,
+									(TimerCallbackFunction_t) txGatherTimerCallback
+									);
+#else
+	nextionHMI_h.txGatherTimer = NULL;
+#endif
+}
+
+/**
+ * @brief Queue a formatted command for transmission
+ * @note  The buffer goes back to the pool when its transmission is completed.
+ * 		  If NEX_TX_GATHER_TIME is set, a free line waits that long for more commands.
+ *
+ * @param *pTxBuff = staging buffer, taken from txFreeQHandle
+ * @retval void
+ */
+void txEngineSubmit(Nextion_TxBuffer_t *pTxBuff) {
+	Nextion_Lane_t *pLane = &nextionHMI_h.txLanes[pTxBuff->lane];
+	uint8_t depth;
+
+	//The ready queue can hold every buffer of the pool, this never blocks
+	xQueueSend(pLane->readyQHandle, &pTxBuff, portMAX_DELAY);
+
+	depth = (uint8_t)uxQueueMessagesWaiting(pLane->readyQHandle);
+	if(depth > pLane->maxDepth) {
+		pLane->maxDepth = depth;
+	}
+
+	txEngineWake();
+}
+
+/**
+ * @brief Transmit the transparent data of an addt command
+ * @note  The line is still locked by the addt command, call it when the display is ready (0xFE).
+ * 		  The data must be copied to txBurst before. The token is completed by the 0xFD answer.
+ *
+ * @param length = number of bytes in txBurst
+ * @param *pToken = completion token
+ * @retval 	STAT_ERROR	= transmission could not be started, the line is unlocked
+ * 			STAT_OK 	= transmission is started
+ */
+Ret_Status_t txEngineTransparentStart(uint16_t length, Nextion_Token_t *pToken) {
+
+	pToken->status = STAT_OK;
+	pToken->xTaskWaiting = NULL;
+	pToken->state = TOKEN_PENDING;
+
+	nextionHMI_h.txBurstCount = 0;
+	nextionHMI_h.txBurstCmdCount = 1;
+	nextionHMI_h.txBurstLength = length;
+	nextionHMI_h.txBurstPace = paceEstimate(PACE_DRAW);
+	expectPush(EXPECT_DONE, PACE_DRAW, pToken, xTaskGetTickCount() + paceWireTicks(length));
+	nextionHMI_h.txBurstExpectCount = 1;
+
+	if(txEngineStart() != HAL_OK) {
+		nextionHMI_h.errorCnt++;
+		//The addt lock ends here, txEngineTransparentEnd() has nothing to do
+		txEngineRelease();
+		nextionHMI_h.txLineBusy = 0;
+		txEngineKick();
+		return STAT_ERROR;
+	}
+	return STAT_OK;
+}
+
+/**
+ * @brief Unlock the line after an addt command
+ * @note  Called when the transparent data is done or the addt failed, and by the reset
+ * 		  which drops the addt in flight. It does nothing if the line is not locked by an addt.
+ *
+ * @param void
+ * @retval void
+ */
+void txEngineTransparentEnd(void) {
+	uint8_t release;
+
+	taskENTER_CRITICAL();
+	release = nextionHMI_h.txTransparent && (!nextionHMI_h.txHoldLine) && (nextionHMI_h.txBurstLength == 0);
+	nextionHMI_h.txTransparent = 0;
+	if(release) {
+		//Otherwise the TX timer callback or the end of the transmission releases it
+		nextionHMI_h.txLineBusy = 0;
+	}
+	taskEXIT_CRITICAL();
+
+	if(release) {
+		txEngineKick();
+	}
+}
+
+/**
+ * @brief Take the line for exclusive use
+ * @note  Waits until the line is free and every command in flight is answered or expired.
+ * 		  The commands submitted in the meantime wait in their lanes until txEngineUnlock().
+ * 		  The owner may transmit in blocking mode only, the TX complete callback is not called.
+ *
+ * @param xTicksToWait = max. waiting time
+ * @retval 	STAT_TIMEOUT	= the line is still busy, it is not taken
+ * 			STAT_OK 		= the line is locked
+ */
+Ret_Status_t txEngineLock(TickType_t xTicksToWait) {
+	TimeOut_t xTimeOut;
+	uint8_t lineClaimed = 0;
+
+	vTaskSetTimeOutState(&xTimeOut);
+	for(;;) {
+		if(!lineClaimed) {
+			taskENTER_CRITICAL();
+			lineClaimed = (nextionHMI_h.txLineBusy == 0);
+			nextionHMI_h.txLineBusy = 1;
+			taskEXIT_CRITICAL();
+		}
+		if( lineClaimed && (nextionHMI_h.expectCount == 0) ) {
+			return STAT_OK;
+		}
+		if(xTaskCheckForTimeOut(&xTimeOut, &xTicksToWait) != pdFALSE) {
+			break;
+		}
+		//Answers and timeouts come from the other tasks
+		vTaskDelay(1);
+	}//end for loop
+
+	if(lineClaimed) {
+		txEngineUnlock();
+	}
+	return STAT_TIMEOUT;
+}
+
+/**
+ * @brief Give back the line taken by txEngineLock()
+ * @note  Sends the commands which have been waiting
+ *
+ * @param void
+ * @retval void
+ */
+void txEngineUnlock(void) {
+	nextionHMI_h.txLineBusy = 0;
+	txEngineKick();
+}
+
+/**
+ * @brief Take the line for a command which is transmitted in segments
+ * @note  The segments are written with txEngineStreamWrite() straight from the memory
+ * 		  of the caller, then txEngineStreamEnd() gives back the line.
+ * 		  The token is completed by the answer of the command, like after a burst.
+ *
+ * @param length = length of the command, with the terminator
+ * @param *pToken = completion token
+ * @retval 	STAT_TIMEOUT	= the line is busy, nothing is sent
+ * 			STAT_OK 		= the line is locked, write the segments
+ */
+Ret_Status_t txEngineStreamBegin(uint16_t length, Nextion_Token_t *pToken) {
+
+	if(txEngineLock(NEX_ANSW_TIMEOUT) != STAT_OK) {
+		return STAT_TIMEOUT;
+	}
+
+	pToken->status = STAT_OK;
+	pToken->xTaskWaiting = NULL;
+	pToken->state = TOKEN_PENDING;
+	expectPush(EXPECT_ACK, PACE_SET, pToken, xTaskGetTickCount() + paceWireTicks(length));
+
+	return STAT_OK;
+}
+
+/**
+ * @brief Transmit one segment of a streamed command
+ * @note  Blocking transmission, the line is locked by txEngineStreamBegin()
+ *
+ * @param *pData = segment, it is not copied
+ * @param length = number of bytes, can be 0
+ * @retval 	STAT_ERROR	= transmission failed
+ * 			STAT_OK 	= segment is on the wire
+ */
+Ret_Status_t txEngineStreamWrite(const uint8_t *pData, uint16_t length) {
+
+	if(length == 0) {
+		return STAT_OK;
+	}
+	if(HAL_UART_Transmit(nextionHMI_h.pUart, (uint8_t*)pData, length, NEX_ANSW_TIMEOUT) != HAL_OK) {
+		return STAT_ERROR;
+	}
+	nextionHMI_h.txByteCnt += length;
+	return STAT_OK;
+}
+
+/**
+ * @brief Give back the line after a streamed command
+ * @note  A failed command is terminated, so it doesn't corrupt the next one,
+ * 		  the display answers it with an error or it times out.
+ * 		  Without success answers the line is held until the TX timer callback.
+ *
+ * @param status = result of the segment writes
+ * @retval void
+ */
+void txEngineStreamEnd(Ret_Status_t status) {
+	static const uint8_t terminator[3] = { 0xFF, 0xFF, 0xFF };
+
+	if(status != STAT_OK) {
+		nextionHMI_h.errorCnt++;
+		txEngineStreamWrite(terminator, sizeof(terminator));
+	}
+	nextionHMI_h.txBurstCnt++;
+
+	if(nextionHMI_h.ifaceVerbose < 3) {
+		//The end of the command is detected by the quiet line
+		nextionHMI_h.txHoldLine = 1;
+		if(nextionHMI_h.hmiStatus != COMP_INVALID) {
+			nextionHMI_h.hmiStatus = COMP_BUSY_TX;
+		}
+		xTimerChangePeriod(nextionHMI_h.blockTx, paceBurstPeriod(paceEstimate(PACE_SET)), portMAX_DELAY);
+	} else {
+		txEngineUnlock();
+	}
+}
+
+/**
+ * @brief Lane of the commands of the calling task
+ * @note  The commands of the touch callbacks go to the interactive lane
+ *
+ * @param void
+ * @retval lane
+ */
+Nx_Tx_Lane_t txEngineLane(void) {
+	if(xTaskGetCurrentTaskHandle() == (TaskHandle_t)hmiObjectTaskHandle) {
+		return LANE_INTERACTIVE;
+	}
+	return LANE_BULK;
+}
+
+/**
+ * @brief Priority lanes of the TX scheduler
+ * @note  Index is Nx_Tx_Lane_t, see Nextion_Lane_t for the metrics
+ *
+ * @param void
+ * @retval pointer to the table of LANE_COUNT entries
+ */
+const Nextion_Lane_t *NxHmi_GetLaneTable(void) {
+	return nextionHMI_h.txLanes;
+}
+
+/**
+ * @brief Number of commands waiting in a lane
+ * @note  --
+ *
+ * @param lane = priority lane
+ * @retval queue depth
+ */
+uint8_t NxHmi_GetLaneDepth(Nx_Tx_Lane_t lane) {
+	if(lane >= LANE_COUNT) {
+		return 0;
+	}
+	return (uint8_t)uxQueueMessagesWaiting(nextionHMI_h.txLanes[lane].readyQHandle);
+}
+
+/**
+ * @brief Start the transmission of the waiting commands or the gathering window
+ * @note  Called when a command is submitted or a mailbox value is posted
+ *
+ * @param void
+ * @retval void
+ */
+void txEngineWake(void) {
+
+	if(nextionHMI_h.txGatherTimer != NULL) {
+		uint8_t lineClaimed;
+
+		taskENTER_CRITICAL();
+		lineClaimed = (nextionHMI_h.txLineBusy == 0);
+		nextionHMI_h.txLineBusy = 1;
+		taskEXIT_CRITICAL();
+
+		if(lineClaimed) {
+			//Hold the line for the gathering window, the timer callback starts the burst
+			xTimerStart(nextionHMI_h.txGatherTimer, portMAX_DELAY);
+		}
+		return;
+	}
+
+	txEngineKick();
+}
+
+/**
+ * @brief Start the next waiting commands if the line is free
+ * @note  Called after a submit, when the line is released and when an answer arrived.
+ * 		  If the line is busy, it will be called again when the line is released.
+ * 		  Every waiting command is coalesced into one burst, up to NEX_TX_BURST_SIZE,
+ * 		  followed by the pending mailbox values, as long as the expectation list has room.
+ *
+ * @param void
+ * @retval void
+ */
+void txEngineKick(void) {
+	uint8_t lineClaimed;
+
+	do {
+		taskENTER_CRITICAL();
+		lineClaimed = (nextionHMI_h.txLineBusy == 0);
+		nextionHMI_h.txLineBusy = 1;
+		taskEXIT_CRITICAL();
+
+		if(!lineClaimed) {
+			//The line is busy, the TX timer callback will continue
+			return;
+		}
+
+		if(txEngineCollect() > 0) {
+			if(txEngineStart() == HAL_OK) {
+				return;
+			}
+			//Transmission could not be started, drop the commands
+			nextionHMI_h.errorCnt++;
+			txEngineRelease();
+		}//end if command is waiting
+
+		nextionHMI_h.txLineBusy = 0;
+		//A command may have been submitted, a value posted or an answer arrived while we held the line
+	} while( ( (txEngineWaiting() > 0) || (nextionHMI_h.mailboxDirtyCnt > 0) ) &&
+			 (expectFree() > 0) );
+}
+
+/**
+ * @brief Transmission of the active burst is completed
+ * @note  Call it from HAL_UART_TxCpltCallback().
+ * 		  With bkcmd=3 every command is answered, the line is released right away and the next
+ * 		  burst can follow, up to NEX_PIPELINE_DEPTH commands in flight.
+ * 		  Otherwise the line is held until the TX timer callback.
+ *
+ * @param *pxHigherPriorityTaskWoken
+ * @retval void
+ */
+void txEngineCompleteFromISR(BaseType_t *pxHigherPriorityTaskWoken) {
+	Nextion_TxBuffer_t *pTxBuff;
+
+	for(uint8_t i = 0; i < nextionHMI_h.txBurstCount; i++) {
+		pTxBuff = nextionHMI_h.txBurstList[i];
+
+		if(pTxBuff->xTaskToNotify != NULL) {
+			// Notify the sending task
+			vTaskNotifyGiveFromISR(pTxBuff->xTaskToNotify, pxHigherPriorityTaskWoken);
+			pTxBuff->xTaskToNotify = NULL;
+		}
+		//The token is in the expectation list already
+		pTxBuff->pToken = NULL;
+		//Give back the buffer to the pool
+		xQueueSendFromISR(nextionHMI_h.txFreeQHandle, &pTxBuff, pxHigherPriorityTaskWoken);
+	}//end for loop
+
+	nextionHMI_h.txByteCnt += nextionHMI_h.txBurstLength;
+	nextionHMI_h.txBurstCount = 0;
+	nextionHMI_h.txBurstCmdCount = 0;
+	nextionHMI_h.txBurstExpectCount = 0;
+	nextionHMI_h.txBurstLength = 0;
+	// The sending task is no longer waiting
+	nextionHMI_h.xTaskToNotify = NULL;
+
+	if( (!nextionHMI_h.txHoldLine) && (!nextionHMI_h.txTransparent) ) {
+		//Release the line, send the next burst from the timer task
+		nextionHMI_h.txLineBusy = 0;
+		xTimerPendFunctionCallFromISR(txEnginePendedKick, NULL, 0, pxHigherPriorityTaskWoken);
+	}
+}
+
+/**
+ * @brief TX gather timer Callback
+ * @note  Fires when the gathering window of a burst is over
+ *
+ * @param *argument
+ * @retval void
+ */
+void txGatherTimerCallback(void *argument) {
+	//Release the line held by txEngineSubmit() and send what has been collected
+	nextionHMI_h.txLineBusy = 0;
+	txEngineKick();
+}
+
+/**
+ * @brief Mark the token as done, then notify the waiting task and call the callback function
+ * @note  Internal use
+ *
+ * @param *pToken = completion token
+ * @param status = result of the command
+ * @retval void
+ */
+void tokenComplete(Nextion_Token_t *pToken, Ret_Status_t status) {
+	TaskHandle_t xTaskWaiting;
+
+	taskENTER_CRITICAL();
+	pToken->status = status;
+	pToken->state = TOKEN_DONE;
+	xTaskWaiting = pToken->xTaskWaiting;
+	pToken->xTaskWaiting = NULL;
+	taskEXIT_CRITICAL();
+
+	if(xTaskWaiting != NULL) {
+		xTaskNotifyGive(xTaskWaiting);
+	}
+	if(pToken->CompleteCallback != NULL) {
+		pToken->CompleteCallback(pToken);
+	}
+}
+
+/**
+ * @brief Initialize a completion token
+ * @note  A token can be reused after it is done
+ *
+ * @param *pToken = completion token
+ * @param callback = called when the command is completed (from the RX or the timer task), or NULL
+ * @param *pUserData = user pointer, available in the callback
+ * @retval void
+ */
+void NxHmi_TokenInit(Nextion_Token_t *pToken, void (*callback)(Nextion_Token_t *pToken), void *pUserData) {
+	pToken->state = TOKEN_IDLE;
+	pToken->status = STAT_OK;
+	pToken->xTaskWaiting = NULL;
+	pToken->CompleteCallback = callback;
+	pToken->pUserData = pUserData;
+	pToken->pResult = NULL;
+}
+
+/**
+ * @brief Poll the token
+ * @note  --
+ *
+ * @param *pToken = completion token
+ * @retval 1 - command is completed, the result is in pToken->status, 0 - in progress
+ */
+uint8_t NxHmi_TokenIsDone(Nextion_Token_t *pToken) {
+	return (pToken->state != TOKEN_PENDING);
+}
+
+/**
+ * @brief Wait for the completion of an async command
+ * @note  Uses the task notification of the calling task
+ *
+ * @param *pToken = completion token
+ * @param xTicksToWait = max. waiting time
+ * @retval 	STAT_TIMEOUT	= the command is still in progress
+ * 			other			= result of the command
+ */
+Ret_Status_t NxHmi_TokenWait(Nextion_Token_t *pToken, TickType_t xTicksToWait) {
+	TaskHandle_t xTaskSelf = xTaskGetCurrentTaskHandle();
+	uint32_t notified;
+	uint8_t stillWaiting;
+
+	taskENTER_CRITICAL();
+	if(pToken->state != TOKEN_PENDING) {
+		taskEXIT_CRITICAL();
+		return pToken->status;
+	}
+	pToken->xTaskWaiting = xTaskSelf;
+	taskEXIT_CRITICAL();
+
+	notified = ulTaskNotifyTake(pdTRUE, xTicksToWait);
+
+	taskENTER_CRITICAL();
+	stillWaiting = (pToken->xTaskWaiting == xTaskSelf);
+	if(stillWaiting) {
+		pToken->xTaskWaiting = NULL;
+	}
+	taskEXIT_CRITICAL();
+
+	if(stillWaiting) {
+		return STAT_TIMEOUT;
+	}
+	if(notified == 0) {
+		//Completed right after the timeout, take the notification which is on its way
+		ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+	}
+	return pToken->status;
+}
+
+//////////////////////////STATIC FUNCTIONS////////////////////////////
+
+/**
+ * @brief Coalesce the waiting commands into the burst buffer
+ * @note  The line must be claimed before calling this function.
+ * 		  The lanes are served in priority order, a lane skipped NEX_TX_LANE_AGING times
+ * 		  is served first. The lower lanes get max. NEX_TX_LOW_LANE_BURST bytes of a burst,
+ * 		  so an interactive command waits for a short burst only.
+ * 		  The worst case wait is longer: the line can be locked by an addt block
+ * 		  (NEX_WAVE_BLOCK_MAX bytes) or a streamed text (NEX_TEXT_STREAM_MAX bytes), e.g. 512 bytes
+ * 		  take 533ms at 9600 and 45ms at 115200 baud. Add the processing time of the commands
+ * 		  in the display and the admission wait of the calling task.
+ * 		  The commands are added to the expectation list in the order of transmission,
+ * 		  a command which expects an answer waits while the list is full.
+ * 		  With bkcmd < 3 an error answer can't be assigned to one of more commands,
+ * 		  so a burst carries max. one command which expects an answer.
+ *
+ * @param void
+ * @retval Number of coalesced commands
+ */
+static uint8_t txEngineCollect(void) {
+	Nextion_TxBuffer_t mailboxCmd;
+	Nextion_Lane_t *pLane;
+	uint16_t length;
+	uint16_t lowLength;
+	uint16_t limit;
+	uint8_t collected[LANE_COUNT] = { 0 };
+	uint8_t order[LANE_COUNT];
+	uint8_t first = LANE_INTERACTIVE;
+	uint8_t n = 0;
+
+	nextionHMI_h.txBurstCount = 0;
+	nextionHMI_h.txBurstCmdCount = 0;
+	nextionHMI_h.txBurstLength = 0;
+	nextionHMI_h.txBurstPace = 0;
+
+	//The oldest skipped lane goes first
+	for(uint8_t i = 1; i < LANE_COUNT; i++) {
+		if( (nextionHMI_h.txLanes[i].age >= NEX_TX_LANE_AGING) &&
+			(nextionHMI_h.txLanes[i].age > nextionHMI_h.txLanes[first].age) ) {
+			first = i;
+		}
+	}//end for loop
+	order[n++] = first;
+	for(uint8_t i = 0; i < LANE_COUNT; i++) {
+		if(i != first) {
+			order[n++] = i;
+		}
+	}//end for loop
+	if(first != LANE_INTERACTIVE) {
+		nextionHMI_h.txLanes[first].agedCnt++;
+	}
+
+	lowLength = 0;
+	for(uint8_t i = 0; i < LANE_COUNT; i++) {
+		pLane = &nextionHMI_h.txLanes[order[i]];
+		length = nextionHMI_h.txBurstLength;
+		if(order[i] == LANE_INTERACTIVE) {
+			collected[order[i]] = txEngineCollectLane(pLane, NEX_TX_BURST_SIZE);
+		} else {
+			limit = (lowLength < NEX_TX_LOW_LANE_BURST) ? (NEX_TX_LOW_LANE_BURST - lowLength) : 0;
+			if( (lowLength == 0) && (limit < (NEX_TX_BUFF_SIZE * NEX_TX_CHAIN_MAX)) ) {
+				//The longest command must fit
+				limit = NEX_TX_BUFF_SIZE * NEX_TX_CHAIN_MAX;
+			}
+			limit += nextionHMI_h.txBurstLength;
+			if(limit > NEX_TX_BURST_SIZE) {
+				limit = NEX_TX_BURST_SIZE;
+			}
+			collected[order[i]] = txEngineCollectLane(pLane, limit);
+			lowLength += nextionHMI_h.txBurstLength - length;
+		}
+		if( (expectFree() == 0) || nextionHMI_h.txTransparent ) {
+			break;
+		}
+	}//end for loop
+
+	for(uint8_t i = 0; i < LANE_COUNT; i++) {
+		pLane = &nextionHMI_h.txLanes[i];
+		if( (collected[i] == 0) && (uxQueueMessagesWaiting(pLane->readyQHandle) > 0) ) {
+			//Skipped while waiting
+			if(pLane->age < UINT8_MAX) {
+				pLane->age++;
+			}
+		} else {
+			pLane->age = 0;
+		}
+	}//end for loop
+
+	//Newest values of the mailbox, if they fit, nobody waits for their answer
+	while( (expectFree() > 0) && (!nextionHMI_h.txTransparent) &&
+		   ( (nextionHMI_h.ifaceVerbose >= 3) || (nextionHMI_h.txBurstExpectCount == 0) ) &&
+		   mailboxCollect(&nextionHMI_h.txBurst[nextionHMI_h.txBurstLength],
+						  NEX_TX_BURST_SIZE - nextionHMI_h.txBurstLength, &mailboxCmd) ) {
+		nextionHMI_h.txBurstLength += mailboxCmd.length;
+		nextionHMI_h.txBurstCmdCount++;
+		nextionHMI_h.txBurstPace += paceEstimate(PACE_SET);
+		expectPush(EXPECT_ACK, PACE_SET, NULL, xTaskGetTickCount() + paceWireTicks(nextionHMI_h.txBurstLength));
+		if(mailboxCmd.pShadowObject != NULL) {
+			expectBindShadow(mailboxCmd.pShadowObject, mailboxCmd.shadowProp);
+		}
+		nextionHMI_h.txBurstExpectCount++;
+	}//end while loop
+
+	return nextionHMI_h.txBurstCmdCount;
+}
+
+/**
+ * @brief Coalesce the waiting commands of one lane into the burst buffer
+ * @note  The line must be claimed before calling this function
+ *
+ * @param *pLane = priority lane
+ * @param maxLength = the burst may grow up to this length
+ * @retval Number of coalesced commands
+ */
+static uint8_t txEngineCollectLane(Nextion_Lane_t *pLane, uint16_t maxLength) {
+	Nextion_TxBuffer_t *pTxBuff, *pPart;
+	uint16_t length;
+	uint8_t expectCount;
+	uint8_t count = 0;
+
+	while(xQueuePeek(pLane->readyQHandle, &pTxBuff, 0) == pdTRUE) {
+		//Length of the command, with the continuation buffers
+		length = 0;
+		for(pPart = pTxBuff; pPart != NULL; pPart = pPart->pNext) {
+			length += pPart->length;
+		}//end for loop
+
+		if( (nextionHMI_h.txBurstLength + length) > maxLength ) {
+			//Leave it for the next burst
+			break;
+		}
+		if( (pTxBuff->expect != EXPECT_NONE) && (expectFree() < pTxBuff->cmdCount) ) {
+			//Too many commands in flight, an answer or a timeout will kick again
+			break;
+		}
+		if( (pTxBuff->expect != EXPECT_NONE) && (nextionHMI_h.ifaceVerbose < 3) && (nextionHMI_h.txBurstExpectCount > 0) ) {
+			//Without success answers an error can't be assigned to one of more commands, one per burst
+			break;
+		}
+		//Only the line holder takes from the queue, the peeked item is the received one
+		xQueueReceive(pLane->readyQHandle, &pTxBuff, 0);
+
+		for(pPart = pTxBuff; pPart != NULL; pPart = pPart->pNext) {
+			memcpy(&nextionHMI_h.txBurst[nextionHMI_h.txBurstLength], pPart->data, pPart->length);
+			nextionHMI_h.txBurstLength += pPart->length;
+			//Every part goes back to the pool after the transmission
+			nextionHMI_h.txBurstList[nextionHMI_h.txBurstCount++] = pPart;
+		}//end for loop
+		nextionHMI_h.txBurstCmdCount += pTxBuff->cmdCount;
+		nextionHMI_h.txBurstPace += paceEstimate(pTxBuff->paceClass) * pTxBuff->cmdCount;
+		if(pTxBuff->expect != EXPECT_NONE) {
+			//Every command of a display list is answered with bkcmd=3, the token goes with the last one.
+			//Below it the list is one entry, its first error fails it
+			expectCount = (nextionHMI_h.ifaceVerbose < 3) ? 1 : pTxBuff->cmdCount;
+			for(uint8_t i = 1; i < expectCount; i++) {
+				expectPush(EXPECT_ACK, pTxBuff->paceClass, NULL,
+						   xTaskGetTickCount() + paceWireTicks(nextionHMI_h.txBurstLength));
+			}//end for loop
+			expectPush(pTxBuff->expect, pTxBuff->paceClass, pTxBuff->pToken,
+					   xTaskGetTickCount() + paceWireTicks(nextionHMI_h.txBurstLength));
+			if(pTxBuff->pShadowObject != NULL) {
+				expectBindShadow(pTxBuff->pShadowObject, pTxBuff->shadowProp);
+			}
+			nextionHMI_h.txBurstExpectCount += expectCount;
+		}
+
+		if(nextionHMI_h.xTaskToNotify == NULL) {
+			nextionHMI_h.xTaskToNotify = pTxBuff->xTaskToNotify;
+		}
+		pLane->sentCnt++;
+		count++;
+
+		if(pTxBuff->expect == EXPECT_READY) {
+			//addt, nothing may follow it until the transparent data is done
+			nextionHMI_h.txTransparent = 1;
+			break;
+		}
+	}//end while loop
+
+	return count;
+}
+
+/**
+ * @brief Number of commands waiting in the lanes
+ * @note  --
+ *
+ * @param void
+ * @retval number of commands
+ */
+static uint8_t txEngineWaiting(void) {
+	uint8_t count = 0;
+
+	for(uint8_t i = 0; i < LANE_COUNT; i++) {
+		count += (uint8_t)uxQueueMessagesWaiting(nextionHMI_h.txLanes[i].readyQHandle);
+	}//end for loop
+	return count;
+}
+
+/**
+ * @brief Put the collected burst on the wire
+ * @note  The line must be claimed before calling this function
+ *
+ * @param void
+ * @retval HAL status
+ */
+static HAL_StatusTypeDef txEngineStart(void) {
+
+	nextionHMI_h.txBurstCnt++;
+	//Without success answers the end of the burst is detected by the quiet line
+	nextionHMI_h.txHoldLine = (nextionHMI_h.ifaceVerbose < 3);
+
+#if NEX_UART_TX_DMA
+	return HAL_UART_Transmit_DMA(nextionHMI_h.pUart, nextionHMI_h.txBurst, nextionHMI_h.txBurstLength);
+#else
+	return HAL_UART_Transmit_IT(nextionHMI_h.pUart, nextionHMI_h.txBurst, nextionHMI_h.txBurstLength);
+#endif
+}
+
+/**
+ * @brief Give back the buffers of a burst which has not been transmitted
+ * @note  Wake up the waiting tasks as well
+ *
+ * @param void
+ * @retval void
+ */
+static void txEngineRelease(void) {
+	Nextion_TxBuffer_t *pTxBuff;
+
+	for(uint8_t i = 0; i < nextionHMI_h.txBurstCount; i++) {
+		pTxBuff = nextionHMI_h.txBurstList[i];
+
+		if(pTxBuff->xTaskToNotify != NULL) {
+			xTaskNotifyGive(pTxBuff->xTaskToNotify);
+			pTxBuff->xTaskToNotify = NULL;
+		}
+		//The token is completed from the expectation list
+		pTxBuff->pToken = NULL;
+		xQueueSend(nextionHMI_h.txFreeQHandle, &pTxBuff, 0);
+	}//end for loop
+
+	expectDropLast(nextionHMI_h.txBurstExpectCount, STAT_ERROR);
+	//Nothing on the wire, the line is not held for the TX timer, an addt doesn't lock it
+	nextionHMI_h.txHoldLine = 0;
+	nextionHMI_h.txTransparent = 0;
+
+	nextionHMI_h.txBurstCount = 0;
+	nextionHMI_h.txBurstCmdCount = 0;
+	nextionHMI_h.txBurstExpectCount = 0;
+	nextionHMI_h.txBurstLength = 0;
+	nextionHMI_h.xTaskToNotify = NULL;
+}
+
+/**
+ * @brief Kick the TX engine from the timer task
+ * @note  Pended from txEngineCompleteFromISR()
+ *
+ * @param *pvParameter1
+ * @param ulParameter2
+ * @retval void
+ */
+static void txEnginePendedKick(void *pvParameter1, uint32_t ulParameter2) {
+	txEngineKick();
+}
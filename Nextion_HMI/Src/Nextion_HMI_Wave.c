@@ -0,0 +1,191 @@
+/*
+ * Nextion_HMI_Wave.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: György Kovács
+ *
+ *      Waveform streaming, samples buffered per channel and sent as addt transparent data
+ */
+
+#include "Nextion_HMI.h"
+
+//PRIVATE FUNCTION PROTOTYPES//
+static Ret_Status_t waveSendBlock(Nextion_WaveChannel_t *pWave);
+
+/**
+ * @brief Clear the streamed channels
+ * @note  Called from NxHmi_Init()
+ *
+ * @param void
+ * @retval void
+ */
+void waveInit(void) {
+	memset(nextionHMI_h.waveChannels, 0x00, sizeof(nextionHMI_h.waveChannels));
+}
+
+/**
+ * @brief Add a sample to a streamed waveform channel
+ * @note  Never blocks, the sample is sent by NxHmi_WaveStreamFlush().
+ * 		  One producer per channel, it can be called from an interrupt as well,
+ * 		  after the first sample of the channel.
+ *
+ * @param *pOb_handle = Nextion waveform object handler
+ * @param channel = On which channel to draw
+ * @param value   = Plot position (0 - Max height)
+ * @retval 	STAT_OK 	= sample is buffered
+ * 			STAT_FAILED = the ring is full, the sample is dropped, or no free channel slot
+ */
+Ret_Status_t NxHmi_WaveStreamAdd(Nextion_Object_t *pOb_handle, uint8_t channel, uint8_t value) {
+	Nextion_WaveChannel_t *pWave = NULL;
+	uint16_t next;
+
+	for(uint8_t i = 0; i < NEX_WAVE_CHANNELS; i++) {
+		if( (nextionHMI_h.waveChannels[i].pObject == pOb_handle) && (nextionHMI_h.waveChannels[i].channel == channel) ) {
+			pWave = &nextionHMI_h.waveChannels[i];
+			break;
+		}
+	}//end for loop
+
+	if(pWave == NULL) {
+		//First sample of the channel, take a free slot
+		taskENTER_CRITICAL();
+		for(uint8_t i = 0; i < NEX_WAVE_CHANNELS; i++) {
+			if(nextionHMI_h.waveChannels[i].pObject == NULL) {
+				pWave = &nextionHMI_h.waveChannels[i];
+				pWave->channel = channel;
+				pWave->head = pWave->tail = 0;
+				pWave->pObject = pOb_handle;
+				break;
+			}
+		}//end for loop
+		taskEXIT_CRITICAL();
+
+		if(pWave == NULL) {
+			return STAT_FAILED;
+		}
+	}
+
+	next = (pWave->head + 1) % NEX_WAVE_RING_SIZE;
+	if(next == pWave->tail) {
+		pWave->dropCnt++;
+		return STAT_FAILED;
+	}
+	pWave->ring[pWave->head] = value;
+	pWave->head = next;
+
+	return STAT_OK;
+}
+
+/**
+ * @brief Send the buffered samples of every streamed channel
+ * @note  Blocks until the blocks are transferred. Call it periodically from one task,
+ * 		  e.g. every 100ms. A block of n samples costs about n + 20 bytes on the wire,
+ * 		  instead of 12 bytes per sample with NxHmi_WaveFormAddValue().
+ * 		  Other commands wait while a block is transferred, see NEX_WAVE_BLOCK_MAX.
+ *
+ * @param void
+ * @retval 	STAT_OK 	= every block has been transferred
+ * 			other		= result of the first failed block, see waveSendBlock()
+ */
+Ret_Status_t NxHmi_WaveStreamFlush(void) {
+	Ret_Status_t retStatus = STAT_OK;
+	Ret_Status_t tmpRet;
+
+	for(uint8_t i = 0; i < NEX_WAVE_CHANNELS; i++) {
+		if(nextionHMI_h.waveChannels[i].pObject == NULL) {
+			continue;
+		}
+		//Max. NEX_WAVE_BLOCK_MAX samples per block, send until the ring is empty
+		while(nextionHMI_h.waveChannels[i].head != nextionHMI_h.waveChannels[i].tail) {
+			tmpRet = waveSendBlock(&nextionHMI_h.waveChannels[i]);
+			if(tmpRet != STAT_OK) {
+				if(retStatus == STAT_OK) {
+					retStatus = tmpRet;
+				}
+				break;
+			}
+		}//end while loop
+	}//end for loop
+
+	return retStatus;
+}
+
+/**
+ * @brief Number of samples dropped because the ring of the channel was full
+ * @note  Per channel counter: nextionHMI_h.waveChannels[i].dropCnt
+ *
+ * @param void
+ * @retval Number of dropped samples since NxHmi_Init()
+ */
+uint32_t NxHmi_GetWaveDropCount(void) {
+	uint32_t count = 0;
+
+	for(uint8_t i = 0; i < NEX_WAVE_CHANNELS; i++) {
+		count += nextionHMI_h.waveChannels[i].dropCnt;
+	}//end for loop
+	return count;
+}
+
+//////////////////////////STATIC FUNCTIONS////////////////////////////
+
+/**
+ * @brief Transfer one block of samples
+ * @note  addt id,ch,n - the display answers 0xFE when it's ready for the n bytes,
+ * 		  and 0xFD when they are done. No other command may be sent in between,
+ * 		  the TX engine locks the line from the addt command until txEngineTransparentEnd().
+ *
+ * @param *pWave = streamed channel
+ * @retval 	STAT_OK 	= block has been transferred
+ * 			other		= see HmiSendAndWait(). If the addt has not been sent (e.g. STAT_BUSY),
+ * 						  the samples are kept for the next flush, otherwise they are dropped.
+ */
+static Ret_Status_t waveSendBlock(Nextion_WaveChannel_t *pWave) {
+	Nextion_Token_t token;
+	Nextion_TxBuffer_t *pTxBuff;
+	Ret_Status_t tmpRet;
+	uint16_t head = pWave->head;
+	uint16_t tail = pWave->tail;
+	uint16_t count = (head + NEX_WAVE_RING_SIZE - tail) % NEX_WAVE_RING_SIZE;
+	uint16_t first;
+	uint8_t locked;
+
+	if(count > NEX_WAVE_BLOCK_MAX) {
+		count = NEX_WAVE_BLOCK_MAX;
+	}
+
+	pTxBuff = prepareToSend(0);
+	encodeCommand(pTxBuff, "addt ", 3, pWave->pObject->Component_ID, pWave->channel, count);
+	pTxBuff->lane = LANE_BACKGROUND;
+	tmpRet = HmiSendAndWait(pTxBuff, EXPECT_READY, NULL);
+	//The addt has been transmitted, it locks the line whatever the answer was.
+	//Not queued (STAT_BUSY), not transmitted or dropped by a reset (STAT_ERROR), the line is not ours
+	locked = (tmpRet == STAT_OK) || (tmpRet == STAT_FAILED) || (tmpRet == STAT_TIMEOUT);
+	if(!locked) {
+		//Keep the samples
+		return tmpRet;
+	}
+
+	if(tmpRet == STAT_OK) {
+		//The line is locked, the burst buffer is free, copy the samples in two parts at the wrap
+		first = NEX_WAVE_RING_SIZE - tail;
+		if(first > count) {
+			first = count;
+		}
+		memcpy(nextionHMI_h.txBurst, &pWave->ring[tail], first);
+		memcpy(&nextionHMI_h.txBurst[first], pWave->ring, count - first);
+
+		NxHmi_TokenInit(&token, NULL, NULL);
+		tmpRet = txEngineTransparentStart(count, &token);
+		if(tmpRet == STAT_OK) {
+			tmpRet = NxHmi_TokenWait(&token, portMAX_DELAY);
+		}
+	}
+	txEngineTransparentEnd();
+
+	//Sent or dropped
+	pWave->tail = (tail + count) % NEX_WAVE_RING_SIZE;
+	if(tmpRet != STAT_OK) {
+		nextionHMI_h.errorCnt++;
+	}
+	return tmpRet;
+}
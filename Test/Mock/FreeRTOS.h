@@ -0,0 +1,34 @@
+/*
+ * FreeRTOS.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: György Kovács
+ *
+ *      Host mock of the FreeRTOS kernel, see mock_rtos.c
+ *      One tick is one millisecond of the simulated time.
+ */
+
+#ifndef _MOCK_FREERTOS_H_
+#define _MOCK_FREERTOS_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef long BaseType_t;
+typedef unsigned long UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdFALSE 					((BaseType_t)0)
+#define pdTRUE 						((BaseType_t)1)
+#define pdPASS 						(pdTRUE)
+#define pdFAIL 						(pdFALSE)
+#define portMAX_DELAY 				((TickType_t)0xFFFFFFFFUL)
+#define configTICK_RATE_HZ 			(1000)
+#define pdMS_TO_TICKS(x) 			((TickType_t)(x))
+
+//The simulation runs in one thread, the tasks don't preempt each other
+#define taskENTER_CRITICAL() 		do { } while(0)
+#define taskEXIT_CRITICAL() 		do { } while(0)
+#define portYIELD_FROM_ISR(x) 		(void)(x)
+
+#endif /* _MOCK_FREERTOS_H_ */
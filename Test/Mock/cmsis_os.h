@@ -0,0 +1,41 @@
+/*
+ * cmsis_os.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: György Kovács
+ *
+ *      Host mock of the CMSIS-RTOS v2 wrapper, see mock_rtos.c
+ */
+
+#ifndef _MOCK_CMSIS_OS_H_
+#define _MOCK_CMSIS_OS_H_
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+
+typedef TaskHandle_t osThreadId_t;
+typedef QueueHandle_t osMessageQueueId_t;
+typedef void (*osThreadFunc_t)(void *argument);
+
+typedef enum {
+	osPriorityLow = 8,
+	osPriorityNormal = 24,
+	osPriorityAboveNormal = 32,
+	osPriorityHigh = 40
+} osPriority_t;
+
+typedef struct {
+	const char *name;
+	uint32_t stack_size;
+	osPriority_t priority;
+} osThreadAttr_t;
+
+typedef struct {
+	const char *name;
+} osMessageQueueAttr_t;
+
+osThreadId_t osThreadNew(osThreadFunc_t func, void *argument, const osThreadAttr_t *attr);
+osMessageQueueId_t osMessageQueueNew(uint32_t msg_count, uint32_t msg_size, const osMessageQueueAttr_t *attr);
+
+#endif /* _MOCK_CMSIS_OS_H_ */
@@ -0,0 +1,53 @@
+/*
+ * mock.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: György Kovács
+ *
+ *      Host simulation of the RTOS, the UART and the display, for the host tests.
+ *      The simulation runs in one thread: the test code is the main task, the timer
+ *      callbacks, the RX task and the UART interrupts run when the main task blocks.
+ */
+
+#ifndef _MOCK_H_
+#define _MOCK_H_
+
+#include "main.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "timers.h"
+
+typedef struct Mock_Display_t {
+	uint32_t setUs; //processing time of an attribute assignment, in microseconds
+	uint32_t drawUs; //pic, fill, line, ...
+	uint32_t refreshUs; //ref, page
+	uint32_t queryUs; //get, sendme, prints
+	const char *failPrefix; //commands starting with it are answered with failCode, NULL - none
+	uint8_t failCode;
+	int32_t value; //returned by get <name>.val and prints <name>.val,4
+	const char *text; //returned by get <name>.txt
+
+	//Statistics
+	uint32_t cmdCnt; //commands executed
+	uint32_t failCnt; //commands answered with an error code
+	uint32_t rxByteCnt; //bytes received by the display
+	uint32_t transparentCnt; //bytes of the addt data
+	uint32_t maxBacklog; //most bytes waiting in the serial buffer of the display
+} Mock_Display_t;
+
+extern Mock_Display_t mockDisplay;
+
+//Simulation
+void mockReset(uint32_t baud);
+void mockKernelStart(void);
+uint64_t mockTimeUs(void);
+uint8_t mockRunStep(void);
+void mockRun(uint64_t durationUs);
+
+//UART and display, used by the simulation
+void mockUartReset(uint32_t baud);
+uint64_t mockUartNextEvent(void);
+void mockUartRunEvent(void);
+uint8_t mockDisplayLevel(void);
+
+#endif /* _MOCK_H_ */
@@ -0,0 +1,473 @@
+/*
+ * mock_rtos.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: György Kovács
+ *
+ *      Host simulation of the FreeRTOS kernel: tasks, notifications, queues and timers.
+ *      Discrete event simulation in one thread, the time jumps to the next event
+ *      when the main task blocks.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "Nextion_HMI.h"
+#include "mock.h"
+
+#define MOCK_TASKS 					(8)
+#define MOCK_QUEUES 				(8)
+#define MOCK_QUEUE_BYTES 			(512)
+#define MOCK_TIMERS 				(8)
+#define MOCK_PENDED 				(16)
+
+struct Mock_Task_t {
+	const char *name;
+	osThreadFunc_t func;
+	uint32_t notify;
+};
+
+struct Mock_Queue_t {
+	uint8_t data[MOCK_QUEUE_BYTES];
+	uint32_t itemSize;
+	uint32_t length;
+	uint32_t head;
+	uint32_t count;
+};
+
+struct Mock_Timer_t {
+	TickType_t period;
+	uint8_t autoReload;
+	uint8_t active;
+	uint64_t expiryUs;
+	TimerCallbackFunction_t callback;
+};
+
+typedef struct {
+	PendedFunction_t func;
+	void *pvParameter1;
+	uint32_t ulParameter2;
+} Mock_Pended_t;
+
+static struct Mock_Task_t mockTasks[MOCK_TASKS];
+static uint8_t mockTaskCount;
+static struct Mock_Queue_t mockQueues[MOCK_QUEUES];
+static uint8_t mockQueueCount;
+static struct Mock_Timer_t mockTimers[MOCK_TIMERS];
+static uint8_t mockTimerCount;
+static Mock_Pended_t mockPended[MOCK_PENDED];
+static uint8_t mockPendedCount;
+
+static TaskHandle_t mockMainTask;
+static TaskHandle_t mockTimerTask;
+static TaskHandle_t mockCurrentTask;
+static uint64_t mockNowUs;
+
+//Defined in Nextion_HMI.c, the RX task is simulated by its loop body
+void StartHmiRxTask(void *argument);
+
+//PRIVATE FUNCTION PROTOTYPES//
+static TaskHandle_t mockTaskNew(const char *name, osThreadFunc_t func);
+static TaskHandle_t mockRxTask(void);
+static uint8_t mockStep(uint64_t limitUs);
+static uint8_t mockWait(uint8_t (*pReady)(void *pArg), void *pArg, TickType_t xTicksToWait);
+static uint8_t mockNotified(void *pArg);
+static uint8_t mockQueueFilled(void *pArg);
+static uint8_t mockQueueHasSpace(void *pArg);
+static uint8_t mockNever(void *pArg);
+static BaseType_t mockQueuePut(QueueHandle_t xQueue, const void *pvItem, uint8_t toFront);
+
+/**
+ * @brief Start a new simulation
+ * @note  Call it before NxHmi_Init(), the time starts at 1 second
+ *
+ * @param baud = rate of the display after reset
+ * @retval void
+ */
+void mockReset(uint32_t baud) {
+	memset(mockTasks, 0x00, sizeof(mockTasks));
+	memset(mockQueues, 0x00, sizeof(mockQueues));
+	memset(mockTimers, 0x00, sizeof(mockTimers));
+	mockTaskCount = mockQueueCount = mockTimerCount = mockPendedCount = 0;
+	mockNowUs = 1000000ULL;
+
+	mockMainTask = mockTaskNew("main", NULL);
+	mockTimerTask = mockTaskNew("Tmr Svc", NULL);
+	mockCurrentTask = mockMainTask;
+	mockUartReset(baud);
+}
+
+/**
+ * @brief Start the created tasks
+ * @note  Replaces osKernelStart(), only the RX task is simulated
+ *
+ * @param void
+ * @retval void
+ */
+void mockKernelStart(void) {
+	TaskHandle_t xSaved = mockCurrentTask;
+
+	mockCurrentTask = mockRxTask();
+	rxStart();
+	mockCurrentTask = xSaved;
+}
+
+/**
+ * @brief Simulated time
+ * @note  --
+ *
+ * @param void
+ * @retval time in microseconds
+ */
+uint64_t mockTimeUs(void) {
+	return mockNowUs;
+}
+
+/**
+ * @brief Run the next event of the simulation
+ * @note  Called by the main task while it polls, e.g. no free TX buffer
+ *
+ * @param void
+ * @retval 1 - an event has been run, 0 - nothing is pending
+ */
+uint8_t mockRunStep(void) {
+	return mockStep(UINT64_MAX);
+}
+
+/**
+ * @brief Run the simulation for a time
+ * @note  --
+ *
+ * @param durationUs = simulated time, in microseconds
+ * @retval void
+ */
+void mockRun(uint64_t durationUs) {
+	uint64_t limitUs = mockNowUs + durationUs;
+
+	while(mockStep(limitUs));
+}
+
+///Tasks
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void) {
+	return mockCurrentTask;
+}
+
+TickType_t xTaskGetTickCount(void) {
+	return (TickType_t)(mockNowUs / 1000U);
+}
+
+void vTaskDelay(TickType_t xTicksToDelay) {
+	mockWait(mockNever, NULL, xTicksToDelay);
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t xClearCountOnExit, TickType_t xTicksToWait) {
+	TaskHandle_t xTask = mockCurrentTask;
+	uint32_t value;
+
+	if(!mockWait(mockNotified, xTask, xTicksToWait)) {
+		return 0;
+	}
+	value = xTask->notify;
+	xTask->notify = xClearCountOnExit ? 0 : (value - 1U);
+	return value;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t xTaskToNotify) {
+	xTaskToNotify->notify++;
+	return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t xTaskToNotify, BaseType_t *pxHigherPriorityTaskWoken) {
+	xTaskToNotify->notify++;
+}
+
+void vTaskSetTimeOutState(TimeOut_t *pxTimeOut) {
+	pxTimeOut->xTimeOnEntering = xTaskGetTickCount();
+}
+
+BaseType_t xTaskCheckForTimeOut(TimeOut_t *pxTimeOut, TickType_t *pxTicksToWait) {
+	TickType_t xElapsed = xTaskGetTickCount() - pxTimeOut->xTimeOnEntering;
+
+	if(*pxTicksToWait == portMAX_DELAY) {
+		return pdFALSE;
+	}
+	if(xElapsed >= *pxTicksToWait) {
+		*pxTicksToWait = 0;
+		return pdTRUE;
+	}
+	*pxTicksToWait -= xElapsed;
+	vTaskSetTimeOutState(pxTimeOut);
+	return pdFALSE;
+}
+
+osThreadId_t osThreadNew(osThreadFunc_t func, void *argument, const osThreadAttr_t *attr) {
+	return mockTaskNew(attr->name, func);
+}
+
+///Queues
+
+osMessageQueueId_t osMessageQueueNew(uint32_t msg_count, uint32_t msg_size, const osMessageQueueAttr_t *attr) {
+	struct Mock_Queue_t *pQueue;
+
+	if( (mockQueueCount >= MOCK_QUEUES) || ((msg_count * msg_size) > MOCK_QUEUE_BYTES) ) {
+		fprintf(stderr, "mock: queue %s does not fit\n", attr->name);
+		abort();
+	}
+	pQueue = &mockQueues[mockQueueCount++];
+	pQueue->itemSize = msg_size;
+	pQueue->length = msg_count;
+	return pQueue;
+}
+
+BaseType_t xQueueSend(QueueHandle_t xQueue, const void *pvItemToQueue, TickType_t xTicksToWait) {
+	if(!mockWait(mockQueueHasSpace, xQueue, xTicksToWait)) {
+		return pdFAIL;
+	}
+	return mockQueuePut(xQueue, pvItemToQueue, 0);
+}
+
+BaseType_t xQueueSendToFront(QueueHandle_t xQueue, const void *pvItemToQueue, TickType_t xTicksToWait) {
+	if(!mockWait(mockQueueHasSpace, xQueue, xTicksToWait)) {
+		return pdFAIL;
+	}
+	return mockQueuePut(xQueue, pvItemToQueue, 1);
+}
+
+BaseType_t xQueueSendFromISR(QueueHandle_t xQueue, const void *pvItemToQueue, BaseType_t *pxHigherPriorityTaskWoken) {
+	return mockQueuePut(xQueue, pvItemToQueue, 0);
+}
+
+BaseType_t xQueueReceive(QueueHandle_t xQueue, void *pvBuffer, TickType_t xTicksToWait) {
+	if(xQueuePeek(xQueue, pvBuffer, xTicksToWait) != pdTRUE) {
+		return pdFALSE;
+	}
+	xQueue->head = (xQueue->head + 1U) % xQueue->length;
+	xQueue->count--;
+	return pdTRUE;
+}
+
+BaseType_t xQueuePeek(QueueHandle_t xQueue, void *pvBuffer, TickType_t xTicksToWait) {
+	if(!mockWait(mockQueueFilled, xQueue, xTicksToWait)) {
+		return pdFALSE;
+	}
+	memcpy(pvBuffer, &xQueue->data[xQueue->head * xQueue->itemSize], xQueue->itemSize);
+	return pdTRUE;
+}
+
+BaseType_t xQueueReset(QueueHandle_t xQueue) {
+	xQueue->head = xQueue->count = 0;
+	return pdPASS;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t xQueue) {
+	return xQueue->count;
+}
+
+UBaseType_t uxQueueSpacesAvailable(QueueHandle_t xQueue) {
+	return xQueue->length - xQueue->count;
+}
+
+///Timers
+
+TimerHandle_t xTimerCreate(const char *pcTimerName, TickType_t xTimerPeriod, UBaseType_t uxAutoReload,
+							void *pvTimerID, TimerCallbackFunction_t pxCallbackFunction) {
+	struct Mock_Timer_t *pTimer;
+
+	if(mockTimerCount >= MOCK_TIMERS) {
+		fprintf(stderr, "mock: too many timers\n");
+		abort();
+	}
+	pTimer = &mockTimers[mockTimerCount++];
+	pTimer->period = xTimerPeriod;
+	pTimer->autoReload = (uint8_t)uxAutoReload;
+	pTimer->callback = pxCallbackFunction;
+	return pTimer;
+}
+
+BaseType_t xTimerStart(TimerHandle_t xTimer, TickType_t xTicksToWait) {
+	xTimer->active = 1;
+	xTimer->expiryUs = mockNowUs + (uint64_t)xTimer->period * 1000U;
+	return pdPASS;
+}
+
+BaseType_t xTimerStop(TimerHandle_t xTimer, TickType_t xTicksToWait) {
+	xTimer->active = 0;
+	return pdPASS;
+}
+
+BaseType_t xTimerChangePeriod(TimerHandle_t xTimer, TickType_t xNewPeriod, TickType_t xTicksToWait) {
+	xTimer->period = xNewPeriod;
+	return xTimerStart(xTimer, xTicksToWait);
+}
+
+BaseType_t xTimerChangePeriodFromISR(TimerHandle_t xTimer, TickType_t xNewPeriod, BaseType_t *pxHigherPriorityTaskWoken) {
+	return xTimerChangePeriod(xTimer, xNewPeriod, 0);
+}
+
+BaseType_t xTimerResetFromISR(TimerHandle_t xTimer, BaseType_t *pxHigherPriorityTaskWoken) {
+	return xTimerStart(xTimer, 0);
+}
+
+BaseType_t xTimerPendFunctionCallFromISR(PendedFunction_t xFunctionToPend, void *pvParameter1,
+							uint32_t ulParameter2, BaseType_t *pxHigherPriorityTaskWoken) {
+	if(mockPendedCount >= MOCK_PENDED) {
+		return pdFAIL;
+	}
+	mockPended[mockPendedCount].func = xFunctionToPend;
+	mockPended[mockPendedCount].pvParameter1 = pvParameter1;
+	mockPended[mockPendedCount].ulParameter2 = ulParameter2;
+	mockPendedCount++;
+	return pdPASS;
+}
+
+//////////////////////////STATIC FUNCTIONS////////////////////////////
+
+static TaskHandle_t mockTaskNew(const char *name, osThreadFunc_t func) {
+	if(mockTaskCount >= MOCK_TASKS) {
+		fprintf(stderr, "mock: too many tasks\n");
+		abort();
+	}
+	mockTasks[mockTaskCount].name = name;
+	mockTasks[mockTaskCount].func = func;
+	return &mockTasks[mockTaskCount++];
+}
+
+static TaskHandle_t mockRxTask(void) {
+	for(uint8_t i = 0; i < mockTaskCount; i++) {
+		if(mockTasks[i].func == StartHmiRxTask) {
+			return &mockTasks[i];
+		}
+	}//end for loop
+	return NULL;
+}
+
+/**
+ * @brief Run the next event, if it's not later than the limit
+ * @note  In the order of priority: pended calls of the timer task, the RX task,
+ * 		  then the earliest of the UART events and the timers. Otherwise the time jumps to the limit.
+ *
+ * @param limitUs = latest time of the event
+ * @retval 1 - an event has been run, 0 - nothing until the limit
+ */
+static uint8_t mockStep(uint64_t limitUs) {
+	TaskHandle_t xSaved = mockCurrentTask;
+	TaskHandle_t xRxTask = mockRxTask();
+	struct Mock_Timer_t *pTimer = NULL;
+	uint64_t nextUs;
+
+	if(mockPendedCount > 0) {
+		Mock_Pended_t pended = mockPended[0];
+
+		mockPendedCount--;
+		memmove(&mockPended[0], &mockPended[1], mockPendedCount * sizeof(Mock_Pended_t));
+		mockCurrentTask = mockTimerTask;
+		pended.func(pended.pvParameter1, pended.ulParameter2);
+		mockCurrentTask = xSaved;
+		return 1;
+	}
+
+	if( (xRxTask != NULL) && (xRxTask->notify > 0) && (mockCurrentTask != xRxTask) ) {
+		//Loop body of StartHmiRxTask()
+		xRxTask->notify = 0;
+		mockCurrentTask = xRxTask;
+		if(nextionHMI_h.rxRestart) {
+			nextionHMI_h.rxRestart = 0;
+			rxStart();
+			nextionHMI_h.rxStartCnt++;
+		} else {
+			rxProcess();
+		}
+		mockCurrentTask = xSaved;
+		return 1;
+	}
+
+	nextUs = mockUartNextEvent();
+	for(uint8_t i = 0; i < mockTimerCount; i++) {
+		if( mockTimers[i].active && (mockTimers[i].expiryUs < nextUs) ) {
+			nextUs = mockTimers[i].expiryUs;
+			pTimer = &mockTimers[i];
+		}
+	}//end for loop
+
+	if( (nextUs == UINT64_MAX) || (nextUs > limitUs) ) {
+		if( (limitUs != UINT64_MAX) && (limitUs > mockNowUs) ) {
+			mockNowUs = limitUs;
+		}
+		return 0;
+	}
+	if(nextUs > mockNowUs) {
+		mockNowUs = nextUs;
+	}
+
+	if(pTimer != NULL) {
+		if(pTimer->autoReload) {
+			pTimer->expiryUs += (uint64_t)pTimer->period * 1000U;
+		} else {
+			pTimer->active = 0;
+		}
+		mockCurrentTask = mockTimerTask;
+		pTimer->callback(pTimer);
+		mockCurrentTask = xSaved;
+	} else {
+		mockUartRunEvent();
+	}
+	return 1;
+}
+
+/**
+ * @brief Block the calling task until a condition is true
+ * @note  Only the main task blocks, the simulated tasks and callbacks return at once
+ *
+ * @param pReady = condition
+ * @param *pArg = argument of the condition
+ * @param xTicksToWait = max. waiting time
+ * @retval 1 - the condition is true, 0 - timeout
+ */
+static uint8_t mockWait(uint8_t (*pReady)(void *pArg), void *pArg, TickType_t xTicksToWait) {
+	uint64_t deadlineUs = (xTicksToWait == portMAX_DELAY) ? UINT64_MAX : (mockNowUs + (uint64_t)xTicksToWait * 1000U);
+
+	while(!pReady(pArg)) {
+		if( (mockCurrentTask != mockMainTask) || (mockNowUs >= deadlineUs) ) {
+			return 0;
+		}
+		if( (!mockStep(deadlineUs)) && (deadlineUs == UINT64_MAX) ) {
+			fprintf(stderr, "mock: the main task waits forever\n");
+			abort();
+		}
+	}//end while loop
+	return 1;
+}
+
+static uint8_t mockNotified(void *pArg) {
+	return ((TaskHandle_t)pArg)->notify > 0;
+}
+
+static uint8_t mockQueueFilled(void *pArg) {
+	return ((QueueHandle_t)pArg)->count > 0;
+}
+
+static uint8_t mockQueueHasSpace(void *pArg) {
+	return ((QueueHandle_t)pArg)->count < ((QueueHandle_t)pArg)->length;
+}
+
+static uint8_t mockNever(void *pArg) {
+	return 0;
+}
+
+static BaseType_t mockQueuePut(QueueHandle_t xQueue, const void *pvItem, uint8_t toFront) {
+	uint32_t index;
+
+	if(xQueue->count >= xQueue->length) {
+		return pdFAIL;
+	}
+	if(toFront) {
+		xQueue->head = (xQueue->head + xQueue->length - 1U) % xQueue->length;
+		index = xQueue->head;
+	} else {
+		index = (xQueue->head + xQueue->count) % xQueue->length;
+	}
+	memcpy(&xQueue->data[index * xQueue->itemSize], pvItem, xQueue->itemSize);
+	xQueue->count++;
+	return pdPASS;
+}
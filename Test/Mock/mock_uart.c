@@ -0,0 +1,533 @@
+/*
+ * mock_uart.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: György Kovács
+ *
+ *      Host simulation of the STM32 HAL UART and of a Nextion display on the other end of the line.
+ *      The bytes take their wire time at the baud rate, 10 bits per character. The display executes
+ *      the commands one after the other, answers them according to its bkcmd level and returns
+ *      the answers to the circular DMA RX ring with the half, full and idle line events.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "Nextion_HMI.h"
+#include "mock.h"
+
+#define MOCK_LINE_SIZE 				(4096) // Bytes on the wire in one direction, power of 2
+#define MOCK_CMD_SIZE 				(1100) // Longest command of the display
+#define MOCK_BOOT_TIME 				(250000) // in microseconds, restart of the display
+
+typedef struct {
+	uint8_t byte;
+	uint32_t baud;
+	uint64_t arrivalUs;
+} Mock_Byte_t;
+
+typedef struct {
+	Mock_Byte_t bytes[MOCK_LINE_SIZE];
+	uint32_t head;
+	uint32_t tail;
+	uint64_t freeUs; //the line is free from this time
+} Mock_Line_t;
+
+Mock_Display_t mockDisplay;
+
+static Mock_Line_t toDisplay;
+static Mock_Line_t toHost;
+
+static UART_HandleTypeDef *pMockUart;
+static uint8_t *pRxRing;
+static uint16_t rxRingSize;
+static uint16_t rxRingPos;
+static uint8_t rxActive;
+static uint8_t rxIdlePending;
+static uint64_t rxIdleUs;
+static uint8_t txActive;
+static uint64_t txEndUs;
+
+static uint32_t displayBaud;
+static uint32_t displayBaudDefault;
+static uint8_t displayLevel;
+static uint8_t displayPage;
+static uint64_t displayBusyUs; //the display is processing a command until this time
+static uint64_t displayBootUs; //the display is restarting until this time
+static uint32_t displayTransparent; //bytes of the addt data to receive
+static uint8_t displayInitPending;
+
+//PRIVATE FUNCTION PROTOTYPES//
+static uint64_t mockCharUs(uint32_t baud);
+static void mockLinePush(Mock_Line_t *pLine, const uint8_t *pData, uint16_t length, uint32_t baud, uint64_t startUs);
+static uint32_t mockLineCount(const Mock_Line_t *pLine);
+static uint64_t mockDisplayNext(uint32_t *pLength);
+static void mockDisplayRun(void);
+static void mockDisplayExecute(const char *pCmd, uint64_t readyUs);
+static uint32_t mockDisplayCost(const char *pCmd);
+static void mockAnswer(const uint8_t *pData, uint16_t length, uint64_t readyUs);
+static void mockAnswerCode(uint8_t code, uint64_t readyUs);
+static void mockRxDeliver(void);
+
+/**
+ * @brief Power on the display
+ * @note  Called by mockReset(), the display is in the default state: bkcmd=2, page 0.
+ * 		  The processing times and the statistics are reset.
+ *
+ * @param baud = default rate of the display
+ * @retval void
+ */
+void mockUartReset(uint32_t baud) {
+	memset(&toDisplay, 0x00, sizeof(toDisplay));
+	memset(&toHost, 0x00, sizeof(toHost));
+	memset(&mockDisplay, 0x00, sizeof(mockDisplay));
+	mockDisplay.setUs = 500;
+	mockDisplay.drawUs = 2000;
+	mockDisplay.refreshUs = 10000;
+	mockDisplay.queryUs = 500;
+
+	pMockUart = NULL;
+	rxActive = rxIdlePending = txActive = 0;
+	displayBaud = displayBaudDefault = baud;
+	displayLevel = 2;
+	displayPage = 0;
+	displayBusyUs = displayBootUs = 0;
+	displayTransparent = 0;
+	displayInitPending = 0;
+}
+
+/**
+ * @brief Time of the next event of the UART and the display
+ * @note  --
+ *
+ * @param void
+ * @retval time in microseconds, UINT64_MAX - nothing is pending
+ */
+uint64_t mockUartNextEvent(void) {
+	uint64_t nextUs = UINT64_MAX;
+	uint64_t eventUs;
+	uint32_t length;
+
+	if( txActive && (txEndUs < nextUs) ) {
+		nextUs = txEndUs;
+	}
+	if( rxIdlePending && (rxIdleUs < nextUs) ) {
+		nextUs = rxIdleUs;
+	}
+	if( (toHost.tail != toHost.head) && (toHost.bytes[toHost.tail].arrivalUs < nextUs) ) {
+		nextUs = toHost.bytes[toHost.tail].arrivalUs;
+	}
+	eventUs = mockDisplayNext(&length);
+	if(eventUs < nextUs) {
+		nextUs = eventUs;
+	}
+	return nextUs;
+}
+
+/**
+ * @brief Run the events of the UART and the display which are due
+ * @note  --
+ *
+ * @param void
+ * @retval void
+ */
+void mockUartRunEvent(void) {
+	uint64_t nowUs = mockTimeUs();
+	uint32_t length;
+
+	if( txActive && (txEndUs <= nowUs) ) {
+		txActive = 0;
+		HAL_UART_TxCpltCallback(pMockUart);
+	}
+	if(mockDisplayNext(&length) <= nowUs) {
+		mockDisplayRun();
+	}
+	mockRxDeliver();
+}
+
+/**
+ * @brief Current bkcmd level of the display
+ * @note  --
+ *
+ * @param void
+ * @retval 0..3
+ */
+uint8_t mockDisplayLevel(void) {
+	return displayLevel;
+}
+
+///HAL
+
+HAL_StatusTypeDef HAL_UART_Init(UART_HandleTypeDef *huart) {
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_DeInit(UART_HandleTypeDef *huart) {
+	rxActive = 0;
+	txActive = 0;
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_Transmit(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size, uint32_t Timeout) {
+	uint64_t startUs = (toDisplay.freeUs > mockTimeUs()) ? toDisplay.freeUs : mockTimeUs();
+
+	if(txActive) {
+		return HAL_BUSY;
+	}
+	pMockUart = huart;
+	mockLinePush(&toDisplay, pData, Size, huart->Init.BaudRate, startUs);
+	//Blocking, the other tasks and the interrupts run meanwhile
+	mockRun(toDisplay.freeUs - mockTimeUs());
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_Transmit_IT(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size) {
+	uint64_t startUs = (toDisplay.freeUs > mockTimeUs()) ? toDisplay.freeUs : mockTimeUs();
+
+	if(txActive) {
+		return HAL_BUSY;
+	}
+	pMockUart = huart;
+	mockLinePush(&toDisplay, pData, Size, huart->Init.BaudRate, startUs);
+	txActive = 1;
+	txEndUs = toDisplay.freeUs;
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_Transmit_DMA(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size) {
+	return HAL_UART_Transmit_IT(huart, pData, Size);
+}
+
+HAL_StatusTypeDef HAL_UARTEx_ReceiveToIdle_DMA(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size) {
+	pMockUart = huart;
+	pRxRing = pData;
+	rxRingSize = Size;
+	rxRingPos = 0;
+	rxIdlePending = 0;
+	rxActive = 1;
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_AbortReceive(UART_HandleTypeDef *huart) {
+	rxActive = 0;
+	rxIdlePending = 0;
+	return HAL_OK;
+}
+
+void Error_Handler(void) {
+	fprintf(stderr, "mock: Error_Handler()\n");
+	abort();
+}
+
+//////////////////////////STATIC FUNCTIONS////////////////////////////
+
+static uint64_t mockCharUs(uint32_t baud) {
+	return 10000000ULL / baud;
+}
+
+/**
+ * @brief Put bytes on the wire
+ * @note  The bytes follow each other at the baud rate, from the start time or when the line becomes free
+ *
+ * @param *pLine = direction
+ * @param *pData = bytes
+ * @param length = number of bytes
+ * @param baud = rate of the sender
+ * @param startUs = earliest start of the first byte
+ * @retval void
+ */
+static void mockLinePush(Mock_Line_t *pLine, const uint8_t *pData, uint16_t length, uint32_t baud, uint64_t startUs) {
+	uint64_t firstUs = (pLine->freeUs > startUs) ? pLine->freeUs : startUs;
+	uint64_t timeUs = firstUs;
+
+	for(uint16_t i = 0; i < length; i++) {
+		if(mockLineCount(pLine) >= (MOCK_LINE_SIZE - 1U)) {
+			fprintf(stderr, "mock: line overflow\n");
+			abort();
+		}
+		timeUs = firstUs + ( (uint64_t)(i + 1U) * 10000000ULL ) / baud;
+		pLine->bytes[pLine->head].byte = pData[i];
+		pLine->bytes[pLine->head].baud = baud;
+		pLine->bytes[pLine->head].arrivalUs = timeUs;
+		pLine->head = (pLine->head + 1U) & (MOCK_LINE_SIZE - 1U);
+	}//end for loop
+	pLine->freeUs = timeUs;
+}
+
+static uint32_t mockLineCount(const Mock_Line_t *pLine) {
+	return (pLine->head - pLine->tail) & (MOCK_LINE_SIZE - 1U);
+}
+
+/**
+ * @brief Time when the display takes its next input
+ * @note  A command is taken when its terminator has arrived and the previous one is done,
+ * 		  the addt data byte by byte
+ *
+ * @param *pLength = bytes of the next input
+ * @retval time in microseconds, UINT64_MAX - no complete input
+ */
+static uint64_t mockDisplayNext(uint32_t *pLength) {
+	uint32_t count = mockLineCount(&toDisplay);
+	uint32_t index = toDisplay.tail;
+	uint8_t ffCount = 0;
+	uint64_t readyUs;
+
+	if(displayInitPending) {
+		return displayBootUs;
+	}
+	if(count == 0) {
+		return UINT64_MAX;
+	}
+	if(displayTransparent > 0) {
+		*pLength = 1;
+		readyUs = toDisplay.bytes[index].arrivalUs;
+		return (readyUs > displayBusyUs) ? readyUs : displayBusyUs;
+	}
+	for(uint32_t i = 0; i < count; i++) {
+		ffCount = (toDisplay.bytes[index].byte == 0xFF) ? (ffCount + 1U) : 0;
+		if(ffCount == 3) {
+			*pLength = i + 1U;
+			readyUs = toDisplay.bytes[index].arrivalUs;
+			return (readyUs > displayBusyUs) ? readyUs : displayBusyUs;
+		}
+		index = (index + 1U) & (MOCK_LINE_SIZE - 1U);
+	}//end for loop
+	return UINT64_MAX;
+}
+
+/**
+ * @brief Take the next input of the display
+ * @note  The bytes sent at an other rate, or during the restart, are lost
+ *
+ * @param void
+ * @retval void
+ */
+static void mockDisplayRun(void) {
+	static char cmd[MOCK_CMD_SIZE];
+	uint64_t nowUs = mockTimeUs();
+	uint32_t length = 0;
+	uint32_t backlog = 0;
+	uint16_t cmdLength = 0;
+	uint8_t garbled = 0;
+	Mock_Byte_t *pByte;
+
+	if(displayInitPending) {
+		const uint8_t initOk[] = { NEX_EVENT_INIT_OK, 0xFF, 0xFF, 0xFF };
+		displayInitPending = 0;
+		mockAnswer(initOk, sizeof(initOk), nowUs);
+		return;
+	}
+	if(mockDisplayNext(&length) > nowUs) {
+		return;
+	}
+
+	//The waiting bytes in the serial buffer of the display
+	for(uint32_t i = toDisplay.tail; i != toDisplay.head; i = (i + 1U) & (MOCK_LINE_SIZE - 1U)) {
+		if(toDisplay.bytes[i].arrivalUs <= nowUs) {
+			backlog++;
+		}
+	}//end for loop
+	if(backlog > mockDisplay.maxBacklog) {
+		mockDisplay.maxBacklog = backlog;
+	}
+
+	for(uint32_t i = 0; i < length; i++) {
+		pByte = &toDisplay.bytes[toDisplay.tail];
+		toDisplay.tail = (toDisplay.tail + 1U) & (MOCK_LINE_SIZE - 1U);
+		mockDisplay.rxByteCnt++;
+		if( (pByte->baud != displayBaud) || (pByte->arrivalUs < displayBootUs) ) {
+			garbled = 1;
+		}
+		if(cmdLength < (MOCK_CMD_SIZE - 1)) {
+			cmd[cmdLength++] = (char)pByte->byte;
+		}
+	}//end for loop
+
+	if(displayTransparent > 0) {
+		mockDisplay.transparentCnt++;
+		if(--displayTransparent == 0) {
+			const uint8_t done[] = { NEX_EVENT_TRANSPARENT_DONE, 0xFF, 0xFF, 0xFF };
+			mockAnswer(done, sizeof(done), nowUs);
+		}
+		return;
+	}
+	if(garbled) {
+		//Not understood, no answer
+		return;
+	}
+	cmd[cmdLength - 3] = '\0';
+	mockDisplayExecute(cmd, nowUs);
+}
+
+/**
+ * @brief Execute a command
+ * @note  The answer is sent when the processing time has elapsed
+ *
+ * @param *pCmd = command without terminator
+ * @param startUs = start of the processing
+ * @retval void
+ */
+static void mockDisplayExecute(const char *pCmd, uint64_t startUs) {
+	uint64_t readyUs = startUs + mockDisplayCost(pCmd);
+	uint8_t answer[MOCK_CMD_SIZE];
+	uint16_t length = 0;
+	const char *pArg;
+
+	displayBusyUs = readyUs;
+	mockDisplay.cmdCnt++;
+
+	if( (mockDisplay.failPrefix != NULL) && (strncmp(pCmd, mockDisplay.failPrefix, strlen(mockDisplay.failPrefix)) == 0) ) {
+		mockAnswerCode(mockDisplay.failCode, readyUs);
+		return;
+	}
+	if(strncmp(pCmd, "bkcmd=", 6) == 0) {
+		displayLevel = (uint8_t)atoi(pCmd + 6);
+		mockAnswerCode(NEX_EVENT_SUCCESS, readyUs);
+		return;
+	}
+	if(strcmp(pCmd, "rest") == 0) {
+		const uint8_t start[] = { 0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF };
+		displayLevel = 2;
+		displayPage = 0;
+		displayBaud = displayBaudDefault;
+		displayTransparent = 0;
+		displayBootUs = startUs + MOCK_BOOT_TIME;
+		displayBusyUs = displayBootUs;
+		displayInitPending = 1;
+		mockAnswer(start, sizeof(start), startUs + (MOCK_BOOT_TIME / 10));
+		return;
+	}
+	if( (strncmp(pCmd, "baud=", 5) == 0) || (strncmp(pCmd, "bauds=", 6) == 0) ) {
+		mockAnswerCode(NEX_EVENT_SUCCESS, readyUs);
+		displayBaud = (uint32_t)atol(strchr(pCmd, '=') + 1);
+		return;
+	}
+	if(strcmp(pCmd, "sendme") == 0) {
+		answer[length++] = 0x66;
+		answer[length++] = displayPage;
+	} else if(strncmp(pCmd, "page ", 5) == 0) {
+		displayPage = (uint8_t)atoi(pCmd + 5);
+		mockAnswerCode(NEX_EVENT_SUCCESS, readyUs);
+		return;
+	} else if( (strncmp(pCmd, "get ", 4) == 0) && (strstr(pCmd, ".txt") != NULL) ) {
+		const char *pText = (mockDisplay.text != NULL) ? mockDisplay.text : "";
+		answer[length++] = 0x70;
+		memcpy(&answer[length], pText, strlen(pText));
+		length += (uint16_t)strlen(pText);
+	} else if(strncmp(pCmd, "get ", 4) == 0) {
+		answer[length++] = 0x71;
+		memcpy(&answer[length], &mockDisplay.value, 4);
+		length += 4;
+	} else if(strncmp(pCmd, "prints ", 7) == 0) {
+		//Raw bytes without terminator
+		mockAnswer((const uint8_t*)&mockDisplay.value, 4, readyUs);
+		return;
+	} else if(strncmp(pCmd, "addt ", 5) == 0) {
+		const uint8_t ready[] = { NEX_EVENT_TRANSPARENT_READY, 0xFF, 0xFF, 0xFF };
+		pArg = strrchr(pCmd, ',');
+		displayTransparent = (pArg != NULL) ? (uint32_t)atol(pArg + 1) : 0;
+		if(displayTransparent > 0) {
+			mockAnswer(ready, sizeof(ready), readyUs);
+		} else {
+			mockAnswerCode(0x1E, readyUs); //invalid number of parameters
+		}
+		return;
+	} else if(strcmp(pCmd, "1") == 0) {
+		mockAnswerCode(0x1A, readyUs); //invalid variable name or attribute
+		return;
+	} else {
+		mockAnswerCode(NEX_EVENT_SUCCESS, readyUs);
+		return;
+	}
+	answer[length++] = 0xFF;
+	answer[length++] = 0xFF;
+	answer[length++] = 0xFF;
+	mockAnswer(answer, length, readyUs);
+}
+
+/**
+ * @brief Processing time of a command
+ * @note  --
+ *
+ * @param *pCmd = command
+ * @retval time in microseconds
+ */
+static uint32_t mockDisplayCost(const char *pCmd) {
+	static const char * const drawKeywords[] = { "pic ", "picq ", "xpic ", "xstr ", "fill ", "line ", "draw ", "cir ", "cirs ", "cle ", "add " };
+
+	if( (strncmp(pCmd, "ref ", 4) == 0) || (strncmp(pCmd, "page ", 5) == 0) ) {
+		return mockDisplay.refreshUs;
+	}
+	if( (strncmp(pCmd, "get ", 4) == 0) || (strncmp(pCmd, "prints ", 7) == 0) || (strcmp(pCmd, "sendme") == 0) ) {
+		return mockDisplay.queryUs;
+	}
+	for(uint8_t i = 0; i < (sizeof(drawKeywords) / sizeof(drawKeywords[0])); i++) {
+		if(strncmp(pCmd, drawKeywords[i], strlen(drawKeywords[i])) == 0) {
+			return mockDisplay.drawUs;
+		}
+	}//end for loop
+	return mockDisplay.setUs;
+}
+
+static void mockAnswer(const uint8_t *pData, uint16_t length, uint64_t readyUs) {
+	mockLinePush(&toHost, pData, length, displayBaud, readyUs);
+}
+
+/**
+ * @brief Answer a command by the bkcmd level
+ * @note  Success at level 1 and 3, failure at level 2 and 3
+ *
+ * @param code = NEX_EVENT_SUCCESS or an error code
+ * @param readyUs = end of the processing
+ * @retval void
+ */
+static void mockAnswerCode(uint8_t code, uint64_t readyUs) {
+	const uint8_t answer[] = { code, 0xFF, 0xFF, 0xFF };
+
+	if(code == NEX_EVENT_SUCCESS) {
+		if( (displayLevel == 1) || (displayLevel == 3) ) {
+			mockAnswer(answer, sizeof(answer), readyUs);
+		}
+		return;
+	}
+	mockDisplay.failCnt++;
+	if(displayLevel >= 2) {
+		mockAnswer(answer, sizeof(answer), readyUs);
+	}
+}
+
+/**
+ * @brief Write the arrived answer bytes into the DMA RX ring
+ * @note  Half and full ring events come in the middle of a stream,
+ * 		  the idle line event one character time after the last byte
+ *
+ * @param void
+ * @retval void
+ */
+static void mockRxDeliver(void) {
+	uint64_t nowUs = mockTimeUs();
+	Mock_Byte_t *pByte;
+
+	while( (toHost.tail != toHost.head) && (toHost.bytes[toHost.tail].arrivalUs <= nowUs) ) {
+		pByte = &toHost.bytes[toHost.tail];
+		toHost.tail = (toHost.tail + 1U) & (MOCK_LINE_SIZE - 1U);
+		if( (!rxActive) || (pMockUart == NULL) || (pByte->baud != pMockUart->Init.BaudRate) ) {
+			//Nobody listens, or framing error at the wrong rate
+			continue;
+		}
+		pRxRing[rxRingPos++] = pByte->byte;
+		rxIdlePending = 1;
+		rxIdleUs = pByte->arrivalUs + mockCharUs(pByte->baud);
+		if(rxRingPos == (rxRingSize / 2)) {
+			HAL_UARTEx_RxEventCallback(pMockUart, rxRingPos);
+		} else if(rxRingPos == rxRingSize) {
+			rxRingPos = 0;
+			HAL_UARTEx_RxEventCallback(pMockUart, rxRingSize);
+		}
+	}//end while loop
+
+	if( rxActive && rxIdlePending && (rxIdleUs <= nowUs) ) {
+		rxIdlePending = 0;
+		HAL_UARTEx_RxEventCallback(pMockUart, rxRingPos);
+	}
+}
@@ -0,0 +1,15 @@
+/*
+ * semphr.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: György Kovács
+ *
+ *      Host mock of the FreeRTOS semaphores, not used by the library
+ */
+
+#ifndef _MOCK_SEMPHR_H_
+#define _MOCK_SEMPHR_H_
+
+#include "queue.h"
+
+#endif /* _MOCK_SEMPHR_H_ */
@@ -0,0 +1,30 @@
+/*
+ * task.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: György Kovács
+ *
+ *      Host mock of the FreeRTOS tasks, see mock_rtos.c
+ */
+
+#ifndef _MOCK_TASK_H_
+#define _MOCK_TASK_H_
+
+#include "FreeRTOS.h"
+
+typedef struct Mock_Task_t *TaskHandle_t;
+
+typedef struct {
+	TickType_t xTimeOnEntering;
+} TimeOut_t;
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+TickType_t xTaskGetTickCount(void);
+void vTaskDelay(TickType_t xTicksToDelay);
+uint32_t ulTaskNotifyTake(BaseType_t xClearCountOnExit, TickType_t xTicksToWait);
+BaseType_t xTaskNotifyGive(TaskHandle_t xTaskToNotify);
+void vTaskNotifyGiveFromISR(TaskHandle_t xTaskToNotify, BaseType_t *pxHigherPriorityTaskWoken);
+void vTaskSetTimeOutState(TimeOut_t *pxTimeOut);
+BaseType_t xTaskCheckForTimeOut(TimeOut_t *pxTimeOut, TickType_t *pxTicksToWait);
+
+#endif /* _MOCK_TASK_H_ */
@@ -0,0 +1,80 @@
+/*
+ * encode_bench.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: György Kovács
+ *
+ *      Host microbenchmark of the command encoder against the snprintf() formatting
+ *      it has replaced, for the numeric setter and the fixed-point text.
+ */
+
+#include <stdio.h>
+#include <time.h>
+#include "Nextion_HMI.h"
+#include "mock.h"
+
+#define BENCH_LOOPS 				(2000000)
+
+static Nextion_Object_t benchObject = { .Name = "page1.n0" };
+static volatile uint32_t benchSink;
+
+//PRIVATE FUNCTION PROTOTYPES//
+static double benchNow(void);
+static void benchReport(const char *name, double encoderSec, double printfSec);
+
+
+int main(void) {
+	Nextion_TxBuffer_t txBuff;
+	char text[NEX_TX_BUFF_SIZE];
+	double start, encoderSec, printfSec;
+	int length;
+
+	//Numeric setter: page1.n0.val=<number><FF FF FF>
+	start = benchNow();
+	for(uint32_t i = 0; i < BENCH_LOOPS; i++) {
+		encodeLocal(&txBuff);
+		encodeObjectProp(&txBuff, &benchObject, SHADOW_VAL);
+		encodeInt(&txBuff, (int32_t)(i * 7919U) - 1000000);
+		encodeEnd(&txBuff);
+		benchSink += txBuff.length;
+	}//end for loop
+	encoderSec = benchNow() - start;
+
+	start = benchNow();
+	for(uint32_t i = 0; i < BENCH_LOOPS; i++) {
+		length = snprintf(text, sizeof(text), "%s.val=%ld\xFF\xFF\xFF", benchObject.Name, (long)((int32_t)(i * 7919U) - 1000000));
+		benchSink += (uint32_t)length;
+	}//end for loop
+	printfSec = benchNow() - start;
+	benchReport("n0.val=<int>", encoderSec, printfSec);
+
+	//Fixed-point text of NxHmi_SetFloatValue()
+	start = benchNow();
+	for(uint32_t i = 0; i < BENCH_LOOPS; i++) {
+		benchSink += formatFixed(text, (float)i * 0.37f - 5000.0f, NEX_FLOAT_DECIMALS);
+	}//end for loop
+	encoderSec = benchNow() - start;
+
+	start = benchNow();
+	for(uint32_t i = 0; i < BENCH_LOOPS; i++) {
+		benchSink += (uint32_t)snprintf(text, sizeof(text), "%.*f", NEX_FLOAT_DECIMALS, (double)((float)i * 0.37f - 5000.0f));
+	}//end for loop
+	printfSec = benchNow() - start;
+	benchReport("float text", encoderSec, printfSec);
+
+	return 0;
+}
+
+//////////////////////////STATIC FUNCTIONS////////////////////////////
+
+static double benchNow(void) {
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (double)now.tv_sec + (double)now.tv_nsec * 1e-9;
+}
+
+static void benchReport(const char *name, double encoderSec, double printfSec) {
+	printf("%-14s encoder %6.1f ns   snprintf %6.1f ns   %4.1fx\n", name,
+			encoderSec * 1e9 / BENCH_LOOPS, printfSec * 1e9 / BENCH_LOOPS, printfSec / encoderSec);
+}
@@ -0,0 +1,231 @@
+/*
+ * rx_stress.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: György Kovács
+ *
+ *      Host stress test of the lock-free RX ring and the touch history.
+ *      A producer thread plays the circular DMA and its RX events, the consumer thread
+ *      runs the parser, a reader thread takes the touch positions. Every 0x67 frame carries
+ *      a sequence number and a check byte, a torn frame or a lost position is detected.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include "Nextion_HMI.h"
+#include "mock.h"
+
+#define STRESS_FRAMES 				(200000)
+
+typedef struct {
+	const char *name;
+	uint8_t throttle; //1 - the line is slower than the parser, 0 - the parser falls behind
+	uint32_t received;
+	uint32_t torn;
+	uint32_t outOfOrder;
+} Stress_Result_t;
+
+static UART_HandleTypeDef stressUart;
+static volatile uint8_t producerDone;
+static volatile uint8_t consumerDone;
+static Stress_Result_t *pResult;
+
+//PRIVATE FUNCTION PROTOTYPES//
+static void stressRun(Stress_Result_t *pRun);
+static void *stressProducer(void *argument);
+static void *stressConsumer(void *argument);
+static void *stressReader(void *argument);
+static uint8_t stressCheck(uint32_t seq);
+
+
+int main(void) {
+	Stress_Result_t runs[] = { { .name = "parser keeps up", .throttle = 1 },
+							   { .name = "parser behind", .throttle = 0 } };
+	int failed = 0;
+
+	printf("%-16s %8s %9s %8s %6s %10s %8s\n", "mode", "frames", "received", "overrun", "torn", "outOfOrder", "touchDrop");
+	for(uint8_t i = 0; i < (sizeof(runs) / sizeof(runs[0])); i++) {
+		stressRun(&runs[i]);
+		printf("%-16s %8u %9u %8u %6u %10u %8u\n", runs[i].name, STRESS_FRAMES, runs[i].received,
+				nextionHMI_h.rxOverrunCnt, runs[i].torn, runs[i].outOfOrder, NxHmi_GetTouchDropCount());
+
+		if( (runs[i].torn > 0) || (runs[i].outOfOrder > 0) || (runs[i].received == 0) ) {
+			failed = 1;
+		}
+		if( runs[i].throttle &&
+			((nextionHMI_h.rxOverrunCnt > 0) || ((runs[i].received + NxHmi_GetTouchDropCount()) != STRESS_FRAMES)) ) {
+			failed = 1;
+		}
+	}//end for loop
+
+	printf("%s\n", failed ? "FAILED" : "PASSED");
+	return failed;
+}
+
+//////////////////////////STATIC FUNCTIONS////////////////////////////
+
+/**
+ * @brief Run the three threads until every frame is sent and parsed
+ * @note  --
+ *
+ * @param *pRun = mode and results
+ * @retval void
+ */
+static void stressRun(Stress_Result_t *pRun) {
+	pthread_t producer, consumer, reader;
+
+	stressUart.Init.BaudRate = 115200;
+	mockReset(stressUart.Init.BaudRate);
+	NxHmi_Init(&stressUart);
+	rxStart();
+
+	pResult = pRun;
+	producerDone = consumerDone = 0;
+	pthread_create(&reader, NULL, stressReader, NULL);
+	pthread_create(&consumer, NULL, stressConsumer, NULL);
+	pthread_create(&producer, NULL, stressProducer, NULL);
+	pthread_join(producer, NULL);
+	pthread_join(consumer, NULL);
+	pthread_join(reader, NULL);
+}
+
+/**
+ * @brief Circular DMA and the RX events of the UART
+ * @note  The half and full transfer events come at the half and the end of the ring,
+ * 		  an idle line event comes at random frame boundaries
+ *
+ * @param *argument
+ * @retval NULL
+ */
+static void *stressProducer(void *argument) {
+	uint8_t frame[9] = { NEX_EVENT_POSITION_HEAD, 0, 0, 0, 0, 0, 0xFF, 0xFF, 0xFF };
+	uint32_t written = 0;
+	uint16_t dmaPos = 0;
+	uint16_t lastEvent = 0;
+	unsigned int seed = 1;
+
+	for(uint32_t seq = 0; seq < STRESS_FRAMES; seq++) {
+		frame[1] = (uint8_t)(seq >> 8);
+		frame[2] = (uint8_t)seq;
+		frame[3] = (uint8_t)(seq >> 24);
+		frame[4] = (uint8_t)(seq >> 16);
+		frame[5] = stressCheck(seq);
+
+		for(uint8_t i = 0; i < sizeof(frame); i++) {
+			if(pResult->throttle) {
+				//The line is slower than the parser, the DMA never gets half a ring ahead
+				while( (written - __atomic_load_n(&nextionHMI_h.rxTail, __ATOMIC_ACQUIRE)) >= (NEX_RX_BUFF_SIZE / 2) ) {
+					sched_yield();
+				}
+			}
+			nextionHMI_h.rxBuff[dmaPos++] = frame[i];
+			written++;
+			if( (dmaPos == (NEX_RX_BUFF_SIZE / 2)) || (dmaPos == NEX_RX_BUFF_SIZE) ) {
+				__sync_synchronize();
+				HAL_UARTEx_RxEventCallback(&stressUart, dmaPos);
+				dmaPos %= NEX_RX_BUFF_SIZE;
+				lastEvent = dmaPos;
+			}
+		}//end for loop
+
+		if( (dmaPos != lastEvent) && ((rand_r(&seed) % 8) == 0) ) {
+			//Idle line between two frames
+			__sync_synchronize();
+			HAL_UARTEx_RxEventCallback(&stressUart, dmaPos);
+			lastEvent = dmaPos;
+		}
+		if((rand_r(&seed) % 4) == 0) {
+			//Let the other threads run on a single core too
+			sched_yield();
+		}
+	}//end for loop
+
+	if(dmaPos != lastEvent) {
+		__sync_synchronize();
+		HAL_UARTEx_RxEventCallback(&stressUart, dmaPos);
+	}
+	producerDone = 1;
+	return NULL;
+}
+
+/**
+ * @brief RX task, parses the ring at random times
+ * @note  --
+ *
+ * @param *argument
+ * @retval NULL
+ */
+static void *stressConsumer(void *argument) {
+	unsigned int seed = 2;
+
+	while(1) {
+		uint8_t done = producerDone;
+		uint32_t tail = nextionHMI_h.rxTail;
+
+		__sync_synchronize();
+		rxProcess();
+		if(done && (nextionHMI_h.rxHead == nextionHMI_h.rxTail)) {
+			break;
+		}
+		if(tail == nextionHMI_h.rxTail) {
+			//Nothing received, wait for the next RX event
+			sched_yield();
+		} else if( (!pResult->throttle) && ((rand_r(&seed) % 256) == 0) ) {
+			//Preempted by a higher priority task
+			usleep(rand_r(&seed) % 200);
+		}
+	}//end while loop
+
+	consumerDone = 1;
+	return NULL;
+}
+
+/**
+ * @brief Application task, takes the touch positions
+ * @note  The sequence numbers must increase, the check byte must match
+ *
+ * @param *argument
+ * @retval NULL
+ */
+static void *stressReader(void *argument) {
+	Nextion_Touch_t touch;
+	uint32_t seq;
+	int64_t lastSeq = -1;
+
+	while(1) {
+		uint8_t done = consumerDone;
+
+		__sync_synchronize();
+		while(NxHmi_TouchRead(&touch) == STAT_OK) {
+			seq = ((uint32_t)touch.yCoordinate << 16) | touch.xCoordinate;
+			if(touch.event != stressCheck(seq)) {
+				pResult->torn++;
+			} else if((int64_t)seq <= lastSeq) {
+				pResult->outOfOrder++;
+			} else {
+				lastSeq = seq;
+				pResult->received++;
+			}
+		}//end while loop
+		if(done) {
+			break;
+		}
+		sched_yield();
+	}//end while loop
+
+	return NULL;
+}
+
+/**
+ * @brief Check byte of a frame
+ * @note  --
+ *
+ * @param seq = sequence number of the frame
+ * @retval check byte
+ */
+static uint8_t stressCheck(uint32_t seq) {
+	return (uint8_t)((seq * 131U) ^ (seq >> 8) ^ (seq >> 16) ^ 0x5AU);
+}
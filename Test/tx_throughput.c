@@ -0,0 +1,99 @@
+/*
+ * tx_throughput.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: György Kovács
+ *
+ *      Host benchmark of the TX engine against the simulated display.
+ *      Queues async value updates as fast as the buffers allow, then reports the
+ *      achieved bytes/s against the wire speed at every baud rate and bkcmd level.
+ */
+
+#include <stdio.h>
+#include "Nextion_HMI.h"
+#include "mock.h"
+
+#define BENCH_OBJECTS 				(8)
+#define BENCH_COMMANDS 				(2000)
+
+static UART_HandleTypeDef benchUart;
+static Nextion_Object_t benchObjects[BENCH_OBJECTS];
+static char benchNames[BENCH_OBJECTS][4];
+
+//PRIVATE FUNCTION PROTOTYPES//
+static void benchRun(uint32_t baud, uint8_t level);
+
+
+int main(void) {
+	const uint32_t rates[] = { 9600, 115200, 921600 };
+
+	for(uint8_t i = 0; i < BENCH_OBJECTS; i++) {
+		snprintf(benchNames[i], sizeof(benchNames[i]), "n%u", i);
+		benchObjects[i].Name = benchNames[i];
+		benchObjects[i].dataType = OBJ_TYPE_INT;
+	}//end for loop
+
+	printf("%8s %6s %10s %7s %9s %7s %8s\n", "baud", "bkcmd", "bytes/s", "line%", "cmd/s", "bursts", "backlog");
+	for(uint8_t i = 0; i < (sizeof(rates) / sizeof(rates[0])); i++) {
+		benchRun(rates[i], 2);
+		benchRun(rates[i], 3);
+	}//end for loop
+	return 0;
+}
+
+//////////////////////////STATIC FUNCTIONS////////////////////////////
+
+/**
+ * @brief Measure one configuration
+ * @note  The objects are added once, NxHmi_Init() doesn't clear the object list
+ *
+ * @param baud = rate of the line
+ * @param level = bkcmd level
+ * @retval void
+ */
+static void benchRun(uint32_t baud, uint8_t level) {
+	static uint8_t objectsAdded = 0;
+	uint32_t byteStart, burstStart, cmdStart;
+	uint64_t startUs, elapsedUs;
+	Ret_Status_t tmpRet;
+	double bytesPerSec;
+
+	benchUart.Init.BaudRate = baud;
+	mockReset(baud);
+	NxHmi_Init(&benchUart);
+	mockKernelStart();
+	if(!objectsAdded) {
+		for(uint8_t i = 0; i < BENCH_OBJECTS; i++) {
+			NxHmi_AddObject(&benchObjects[i]);
+		}//end for loop
+		objectsAdded = 1;
+	}
+	NxHmi_ResetDevice();
+	if(level != nextionHMI_h.ifaceVerbose) {
+		NxHmi_Verbosity(level);
+	}
+
+	byteStart = nextionHMI_h.txByteCnt;
+	burstStart = nextionHMI_h.txBurstCnt;
+	cmdStart = mockDisplay.cmdCnt;
+	startUs = mockTimeUs();
+	for(uint32_t i = 0; i < BENCH_COMMANDS; i++) {
+		do {
+			//The shadow cache is not attached, every value is sent
+			tmpRet = NxHmi_SetIntValueAsync(&benchObjects[i % BENCH_OBJECTS], (int16_t)i, NULL);
+			if(tmpRet != STAT_OK) {
+				//No free TX buffer, let the line run
+				mockRunStep();
+			}
+		} while(tmpRet != STAT_OK);
+	}//end for loop
+	//Wait until everything has been sent and executed
+	NxHmi_SetIntValue(&benchObjects[0], 0);
+	elapsedUs = mockTimeUs() - startUs;
+
+	bytesPerSec = (double)(nextionHMI_h.txByteCnt - byteStart) * 1000000.0 / (double)elapsedUs;
+	printf("%8u %6u %10.0f %6.1f%% %9.0f %7u %8u\n", baud, level, bytesPerSec,
+			bytesPerSec * 10.0 * 100.0 / (double)baud,
+			(double)(mockDisplay.cmdCnt - cmdStart) * 1000000.0 / (double)elapsedUs,
+			nextionHMI_h.txBurstCnt - burstStart, mockDisplay.maxBacklog);
+}